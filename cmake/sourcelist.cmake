@@ -1,25 +1,59 @@
 set(SOURCES
+	include/BudgetCache.h
+	include/DuplicateSubtitles.h
 	include/Hooks.h
 	include/ImGui/FontStyles.h
 	include/ImGui/Renderer.h
 	include/ImGui/Util.h
+	include/Language.h
+	include/LazySubtitleTable.h
+	include/LineBreak.h
 	include/Localization.h
+	include/LocalizationCache.h
+	include/LocalizedStringTable.h
+	include/LocalizedTables.h
+	include/MPSCQueue.h
 	include/Manager.h
 	include/PCH.h
 	include/RE.h
+	include/RayBatch.h
 	include/RayCaster.h
+	include/RaycastScheduler.h
 	include/SettingLoader.h
+	include/SnapshotPtr.h
+	include/StringFileIndex.h
+	include/StringTableParser.h
+	include/SubtitleTable.h
 	include/Subtitles.h
+	include/TextLayout.h
+	include/UTF8.h
+	include/VisibilityCache.h
+	src/DuplicateSubtitles.cpp
 	src/Hooks.cpp
 	src/ImGui/FontStyles.cpp
 	src/ImGui/Renderer.cpp
 	src/ImGui/Util.cpp
+	src/Language.cpp
+	src/LazySubtitleTable.cpp
+	src/LineBreak.cpp
 	src/Localization.cpp
+	src/LocalizationCache.cpp
+	src/LocalizedStringTable.cpp
+	src/LocalizedTables.cpp
 	src/Manager.cpp
 	src/PCH.cpp
 	src/RE.cpp
+	src/RayBatch.cpp
 	src/RayCaster.cpp
+	src/RaycastScheduler.cpp
 	src/SettingLoader.cpp
+	src/StringFileIndex.cpp
+	src/StringTableParser.cpp
+	src/SubtitleTable.cpp
 	src/Subtitles.cpp
+	src/TextLayout.cpp
+	src/UTF8.cpp
+	src/UTF8Kernel.inl
+	src/VisibilityCache.cpp
 	src/main.cpp
 )
@@ -0,0 +1,102 @@
+#pragma once
+
+// Cache bounded by the bytes its values hold, evicted least recently used first.
+// Eviction skips values the caller still needs and trims down to 3/4 of the budget, so the scan doesn't run for
+// every insert once the cache is full. Not thread safe, the owner serializes access.
+template <class Key, class Value>
+class BudgetCache
+{
+public:
+	struct Entry
+	{
+		Value         value;
+		std::size_t   size{ 0 };      // resident bytes, including the key
+		std::uint64_t lastUsed{ 0 };  // tick of the last Find or Insert
+	};
+
+	explicit BudgetCache(std::size_t a_budget = 0) :
+		budget(a_budget)
+	{}
+
+	void        SetBudget(std::size_t a_budget) { budget = a_budget; }
+	std::size_t GetBudget() const { return budget; }  // 0 = unbounded
+
+	std::size_t   GetSize() const { return entries.size(); }
+	std::size_t   GetResidentBytes() const { return residentBytes; }
+	std::uint64_t GetEvictions() const { return evictions; }
+
+	bool Contains(const Key& a_key) const { return entries.contains(a_key); }
+
+	// marks the entry as used
+	Value* Find(const Key& a_key)
+	{
+		const auto it = entries.find(a_key);
+		if (it == entries.end()) {
+			return nullptr;
+		}
+		it->second.lastUsed = ++tick;
+		return &it->second.value;
+	}
+
+	// inserts or replaces, nothing is evicted until Evict
+	Value& Insert(const Key& a_key, Value&& a_value, std::size_t a_size)
+	{
+		auto [it, inserted] = entries.try_emplace(a_key, std::move(a_value), a_size);
+
+		auto& entry = it->second;
+		if (inserted) {
+			residentBytes += a_size;
+		} else {
+			residentBytes = residentBytes - entry.size + a_size;
+			entry.value = std::move(a_value);
+			entry.size = a_size;
+		}
+		entry.lastUsed = ++tick;
+		return entry.value;
+	}
+
+	// a_isLive(const Value&) keeps values in use, however old they are
+	template <class F>
+	void Evict(F&& a_isLive)
+	{
+		if (budget == 0 || residentBytes <= budget) {
+			return;
+		}
+
+		std::vector<std::pair<std::uint64_t, const Key*>> candidates;
+		for (const auto& [key, entry] : entries) {
+			if (!a_isLive(entry.value)) {
+				candidates.emplace_back(entry.lastUsed, &key);
+			}
+		}
+		std::ranges::sort(candidates);
+
+		const auto target = budget / 4 * 3;
+		for (const auto& [lastUsed, key] : candidates) {
+			if (residentBytes <= target) {
+				break;
+			}
+			const auto it = entries.find(*key);
+			residentBytes -= it->second.size;
+			entries.erase(it);
+			++evictions;
+		}
+	}
+
+	// a_func(const Key&, Value&)
+	template <class F>
+	void ForEach(F&& a_func)
+	{
+		for (auto& [key, entry] : entries) {
+			a_func(key, entry.value);
+		}
+	}
+
+private:
+	// members
+	FlatMap<Key, Entry> entries;
+	std::size_t         budget;
+	std::size_t         residentBytes{ 0 };
+	std::uint64_t       tick{ 0 };
+	std::uint64_t       evictions{ 0 };
+};
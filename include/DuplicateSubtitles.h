@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Language.h"
+#include "SubtitleTable.h"
+
+// Game language text shared by several string ids, and the id whose translations are shown for it when the topic is
+// not known: the one with the fewest strings across languages, the longest strings on a tie.
+// Ids are ranked and picked in parallel, the picks come out the same under any execution policy.
+class DuplicateSubtitles
+{
+public:
+	using SubtitleID = SubtitleTable::SubtitleID;
+	using SubtitleToIDMap = FlatMap<std::string_view, FlatSet<SubtitleID>>;  // views into the parsed tables
+	using IDToSubtitleMap = FlatMap<SubtitleID, FlatMap<Language, FlatSet<std::string_view>>>;
+	using Languages = IDToSubtitleMap::mapped_type;
+
+	struct Pick
+	{
+		const SubtitleToIDMap::value_type* subtitle;  // text and every id it appears under
+		SubtitleID                         bestID;
+	};
+
+	template <class ExecutionPolicy>
+	DuplicateSubtitles(ExecutionPolicy&& a_policy, const SubtitleToIDMap& a_subToID, const IDToSubtitleMap& a_idToSub);
+
+	// the string shown for a language with several under one id, the first in the set's own order. the set holds the
+	// same strings added in the same load order whether a language is built at startup or loaded later, so both agree
+	static std::string_view PickSubtitle(const FlatSet<std::string_view>& a_subtitles) { return *a_subtitles.begin(); }
+
+	// one per text, in a_subToID iteration order
+	std::span<const Pick> GetPicks() const { return picks; }
+	const Languages&      GetLanguages(SubtitleID a_id) const { return *idStats.at(a_id).languages; }
+
+private:
+	struct IDStats
+	{
+		std::size_t      count{ 0 };
+		std::size_t      totalLen{ 0 };
+		const Languages* languages{ nullptr };
+	};
+
+	SubtitleID PickBestID(const FlatSet<SubtitleID>& a_ids) const;
+
+	// members
+	FlatMap<SubtitleID, IDStats> idStats;
+	std::vector<Pick>            picks;
+};
+
+template <class ExecutionPolicy>
+DuplicateSubtitles::DuplicateSubtitles(ExecutionPolicy&& a_policy, const SubtitleToIDMap& a_subToID, const IDToSubtitleMap& a_idToSub)
+{
+	// per id stats are computed once, not for every candidate set the id shows up in
+	std::vector<const IDToSubtitleMap::value_type*> idEntries;
+	idEntries.reserve(a_idToSub.size());
+	for (const auto& entry : a_idToSub) {
+		idEntries.push_back(&entry);
+	}
+
+	std::vector<IDStats> stats(idEntries.size());
+	std::transform(a_policy, idEntries.begin(), idEntries.end(), stats.begin(), [](const auto* a_entry) {
+		IDStats stat{ 0, 0, &a_entry->second };
+		for (const auto& [lang, subs] : a_entry->second) {
+			stat.count += subs.size();
+			for (const auto& s : subs) {
+				stat.totalLen += s.size();
+			}
+		}
+		return stat;
+	});
+
+	idStats.reserve(idEntries.size());
+	for (std::size_t i = 0; i < idEntries.size(); ++i) {
+		idStats.emplace(idEntries[i]->first, stats[i]);
+	}
+
+	// picks only read the stats, the order they are returned in is fixed before they run
+	picks.reserve(a_subToID.size());
+	for (const auto& entry : a_subToID) {
+		picks.push_back({ &entry, 0 });
+	}
+
+	std::for_each(a_policy, picks.begin(), picks.end(), [&](Pick& a_pick) {
+		a_pick.bestID = PickBestID(a_pick.subtitle->second);
+	});
+}
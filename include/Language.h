@@ -0,0 +1,22 @@
+#pragma once
+
+enum class Language
+{
+	kNative = static_cast<std::underlying_type_t<Language>>(-1),
+	kChinese,
+	kGerman,
+	kEnglish,
+	kSpanish,
+	kLatinAmericanSpanish,
+	kFrench,
+	kItalian,
+	kJapanese,
+	kPolish,
+	kPortuguese,
+	kRussian,
+
+	kTotal
+};
+
+std::string to_string(Language lang);
+Language    to_language(std::string_view string);
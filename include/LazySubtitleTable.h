@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Language.h"
+#include "LocalizedStringTable.h"
+#include "SubtitleTable.h"
+
+// Opt-in alternative to SubtitleTable that keeps only string table directories and hashes of the index language
+// strings in memory. Translations are read from the string tables the first time they are requested.
+class LazySubtitleTable
+{
+public:
+	using SubtitleID = SubtitleTable::SubtitleID;
+
+	// a string table file, the game's resource streams in game and memory in tests
+	class Stream
+	{
+	public:
+		virtual ~Stream() = default;
+
+		virtual std::uint64_t GetSize() const = 0;
+		virtual void          Seek(std::uint64_t a_position) = 0;
+		// from the current position, never past GetSize
+		virtual void Read(void* a_buffer, std::uint32_t a_size) = 0;
+	};
+
+	// called from any thread, null when the file can't be opened
+	using OpenFunc = std::function<std::unique_ptr<Stream>(const std::string& a_path)>;
+
+	struct File
+	{
+		std::string                                          path;
+		RE::LocalizedStringTable::Type                       type{ RE::LocalizedStringTable::Type::kILStrings };
+		std::uint32_t                                        dataOffset{ 0 };
+		FlatMap<std::uint32_t, std::uint32_t>                directory;  // string id -> offset relative to dataOffset
+		std::vector<std::pair<std::uint64_t, std::uint32_t>> hashes;     // (string hash, string id), index language only
+	};
+
+	explicit LazySubtitleTable(OpenFunc a_open) :
+		open(std::move(a_open))
+	{}
+
+	// reads the directory (and string hashes for the index language) of a single table, safe to call from worker threads
+	std::optional<File> ReadFile(const std::string& a_path, RE::LocalizedStringTable::Type a_type, bool a_hashStrings) const;
+
+	void Clear();
+	void SetIndexLanguage(Language a_language) { indexLanguage = a_language; }
+	void AddFile(std::uint32_t a_modIndex, Language a_language, File&& a_file);
+
+	std::size_t GetIndexedCount() const { return reverseIndex.size(); }
+	// ids whose index language string hashes the same are checked against a_string itself, read like any other string.
+	// the first match from a plugin in a_preferredMods wins, in their order, then the first match in load order
+	std::optional<SubtitleID>  FindID(std::string_view a_string, std::span<const std::uint32_t> a_preferredMods = {}) const;
+	std::optional<std::string> GetString(SubtitleID a_id, Language a_language) const;
+
+	std::size_t GetMemoryUsage() const;
+
+private:
+	using CacheList = std::list<std::pair<std::uint64_t, std::string>>;
+
+	struct OpenStream
+	{
+		std::uint64_t           fileKey;
+		std::unique_ptr<Stream> stream;
+	};
+
+	static std::uint64_t HashString(std::string_view a_string) { return std::hash<std::string_view>{}(a_string); }
+	static std::uint32_t GetModIndex(SubtitleID a_id) { return static_cast<std::uint32_t>(a_id >> 32); }
+	static std::uint64_t GetFileKey(std::uint32_t a_modIndex, Language a_language, RE::LocalizedStringTable::Type a_type) { return (static_cast<std::uint64_t>(a_modIndex) << 32) | (static_cast<std::uint64_t>(std::to_underlying(a_type)) << 8) | static_cast<std::uint8_t>(std::to_underlying(a_language)); }
+	static std::uint64_t GetCacheKey(SubtitleID a_id, Language a_language) { return a_id | (static_cast<std::uint64_t>(std::to_underlying(a_language)) << 56); }  // mod indices never reach bit 56
+
+	std::optional<std::string>        ReadString(SubtitleID a_id, Language a_language) const;
+	OpenStream*                       GetStream(std::uint64_t a_fileKey, const File& a_file) const;
+	static std::optional<std::string> ReadString(Stream& a_stream, const File& a_file, std::uint32_t a_offset);
+
+	static constexpr std::size_t maxCachedStrings = 256;
+	static constexpr std::size_t maxOpenStreams = 8;  // archived tables may be held decompressed, so not one per file
+
+	// members
+	OpenFunc                                            open;
+	Language                                            indexLanguage{ Language::kEnglish };
+	FlatMap<std::uint64_t, File>                        files;         // (mod index, table type, language) -> file
+	FlatMap<std::uint64_t, SubtitleID>                  reverseIndex;  // index language string hash -> first id in load order
+	FlatMap<std::uint64_t, std::vector<SubtitleID>>     alternateIDs;  // hash -> the other ids, same line in other plugins or a collision
+	mutable std::mutex                                  cacheLock;
+	mutable CacheList                                   cache;  // most recently used first
+	mutable FlatMap<std::uint64_t, CacheList::iterator> cacheMap;
+	mutable std::list<OpenStream>                       streams;  // most recently used first
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+// UAX #14 line breaking, reduced to the break classes that show up in game dialogue.
+// Classes come from two-stage lookup tables generated at compile time, pairs are resolved through a
+// table built from the rules (LB4-LB31), so nothing is range checked per character at runtime.
+namespace LineBreak
+{
+	enum class Class : std::uint8_t
+	{
+		kAL,  // alphabetic, also the default
+		kBA,  // break after
+		kBB,  // break before
+		kBK,  // mandatory break
+		kCJ,  // small kana and the prolonged sound mark, NS under strict kinsoku and ID otherwise
+		kCL,  // close punctuation
+		kCM,  // combining mark
+		kCP,  // close parenthesis
+		kCR,
+		kEX,  // exclamation/interrogation
+		kGL,  // non-breaking glue
+		kHY,  // hyphen
+		kID,  // ideographic, also dictionary-less fallback for Thai syllables
+		kIN,  // inseparable
+		kIS,  // infix separator
+		kLF,
+		kNS,  // nonstarter, iteration marks and sentence punctuation
+		kNU,  // numeric
+		kOP,  // open punctuation
+		kOPW,  // east asian wide open punctuation, OP that LB30 does not join to a preceding word
+		kPO,  // postfix numeric
+		kPR,  // prefix numeric
+		kQU,  // quotation
+		kSP,  // space
+		kSY,  // solidus
+		kWJ,  // word joiner
+		kZW,  // zero width space
+
+		kTotal
+	};
+
+	enum class Break : std::uint8_t
+	{
+		kNone,
+		kAllowed,
+		kMandatory
+	};
+
+	Class GetClass(char32_t a_codePoint);
+
+	// feed every code point of a string in order, returns the break opportunity before it
+	class Breaker
+	{
+	public:
+		Break Next(Class a_class);
+
+	private:
+		// members
+		Class prev{ Class::kWJ };
+		bool  sawSpace{ false };
+		bool  started{ false };
+	};
+}
@@ -1,26 +1,18 @@
 #pragma once
 
-enum class Language
+#include "Language.h"
+#include "LazySubtitleTable.h"
+#include "LocalizedTables.h"
+#include "StringFileIndex.h"
+#include "StringTableParser.h"
+
+// the parts of a LanguageSetting the layout worker needs, copied on the main thread
+struct LayoutLanguage
 {
-	kNative = static_cast<std::underlying_type_t<Language>>(-1),
-	kChinese,
-	kGerman,
-	kEnglish,
-	kSpanish,
-	kLatinAmericanSpanish,
-	kFrench,
-	kItalian,
-	kJapanese,
-	kPolish,
-	kPortuguese,
-	kRussian,
-
-	kTotal
+	Language      language{ Language::kEnglish };
+	std::uint32_t maxCharsPerLine{ 80 };
 };
 
-std::string to_string(Language lang);
-Language    to_language(std::string_view string);
-
 template <std::uint32_t id1, std::uint32_t id2>
 struct LanguageSetting
 {
@@ -37,6 +29,8 @@ struct LanguageSetting
 		return language.changed() || maxCharsPerLine.changed();  // rebuild subtitles
 	}
 
+	LayoutLanguage Get() const { return { language.get(), maxCharsPerLine.get() }; }
+
 	RE::Global<Language, id1>      language{ Language::kNative };
 	RE::Global<std::uint32_t, id2> maxCharsPerLine{ 80 };
 };
@@ -50,6 +44,7 @@ struct LocalizedSubtitle
 	std::string   subtitle;
 	std::uint32_t maxCharsPerLine;
 	Language      language{ Language::kEnglish };
+	bool          fromStringTable{ false };  // otherwise the game's own text, in whatever script its plugin was written in
 };
 
 class LocalizedSubtitles
@@ -59,51 +54,83 @@ public:
 
 	bool LoadGlobalSettings();
 	void PostSettingsLoad();
+	bool ConsumeLoadedLanguages();
+
+	// main thread only, the settings are written there
+	LayoutLanguage GetPrimaryLanguage() const { return primaryLanguage.Get(); }
+	LayoutLanguage GetSecondaryLanguage() const { return secondaryLanguage.Get(); }
 
-	LocalizedSubtitle GetPrimarySubtitle(const char* a_localSubtitle) const;
-	LocalizedSubtitle GetSecondarySubtitle(const char* a_localSubtitle) const;
+	// safe from any thread, the language comes from a snapshot taken on the main thread
+	LocalizedSubtitle GetLocalizedSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, const LayoutLanguage& a_language) const;
+
+	// plugins the translation of a line spoken under this topic is picked from, see FindRow
+	static std::uint64_t GetPluginKey(const RE::TESTopicInfo* a_topicInfo);
 
 private:
-	using SubtitleID = std::uint64_t;  // hashed id (string id + mod index)
+	friend class LocalizationCache;
 
-	using MultiSubtitleToIDMap = FlatMap<std::string, FlatSet<SubtitleID>>;
-	using MultiIDToSubtitleMap = FlatMap<SubtitleID, FlatMap<Language, FlatSet<std::string>>>;
+	using SubtitleID = SubtitleTable::SubtitleID;  // (mod index << 32) | string id
+	using Row = SubtitleTable::Row;
 
-	using SubtitleToIDMap = FlatMap<std::string, SubtitleID>;
-	using IDToSubtitleMap = FlatMap<SubtitleID, FlatMap<Language, std::string>>;
+	using LanguageSet = std::bitset<std::to_underlying(Language::kTotal)>;
+	using Lock = std::shared_mutex;
+	using ReadLocker = std::shared_lock<Lock>;
+	using WriteLocker = std::unique_lock<Lock>;
 
-	void ReadILStringFiles(MultiSubtitleToIDMap& a_multiSubToID, MultiIDToSubtitleMap& a_multiIDToSub) const;
-	void MergeDuplicateSubtitles(const MultiSubtitleToIDMap& a_multiSubToID, const MultiIDToSubtitleMap& a_multiIDToSub);
+	using StringTableType = RE::LocalizedStringTable::Type;
 
-	template <std::uint32_t id1, std::uint32_t id2>
-	std::string ResolveSubtitle(const char* a_localSubtitle, const LanguageSetting<id1, id2>& a_language) const
+	struct StringFile
 	{
-		if (a_language == gameLanguage) {
-			return a_localSubtitle;
-		}
+		std::string     path;
+		std::uint32_t   modIndex;
+		Language        language;
+		StringTableType type;
+	};
 
-		if (const auto idIt = subtitleToID.find(a_localSubtitle); idIt != subtitleToID.end()) {
-			if (const auto mapIt = idToSubtitle.find(idIt->second); mapIt != idToSubtitle.end()) {
-				if (const auto subtitleIt = mapIt->second.find(a_language.language.get()); subtitleIt != mapIt->second.end()) {
-					return subtitleIt->second;
-				}
-			}
-		}
+	using StringTable = StringTableParser::Table;
 
-		return a_localSubtitle;
-	}
+	static StringTable              ParseStringFile(const StringFile& a_file);
+	static std::vector<StringTable> ParseStringFiles(const std::vector<StringFile>& a_files);
+	static std::vector<Language>    GetFileLanguages(const std::vector<StringFile>& a_files);
 
-	template <std::uint32_t id1, std::uint32_t id2>
-	LocalizedSubtitle GetLocalizedSubtitle(const char* a_localSubtitle, const LanguageSetting<id1, id2>& a_setting) const
-	{
-		auto localizedSub = ResolveSubtitle(a_localSubtitle, a_setting);
-		return { localizedSub, a_setting.maxCharsPerLine.get(), localizedSub == a_localSubtitle ? gameLanguage : a_setting.language.get() };
-	}
+	static std::uint32_t GetModIndex(const RE::TESFile* a_file);
+	static std::uint32_t GetModIndex(SubtitleID a_id) { return static_cast<std::uint32_t>(a_id >> 32); }
+
+	Row         FindRow(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo) const;
+	std::string FindSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, Language a_language) const;
+
+	void LogMemoryUsage() const;
+
+	std::vector<StringFile> CollectStringFiles() const;
+	std::vector<StringFile> GetStringFiles(LanguageSet a_languages) const;
+
+	LanguageSet GetConfiguredLanguages() const;
+	void        LoadLanguagesAsync(LanguageSet a_languages);
+	void        RunLanguageLoader(std::stop_token a_token);
+	void        LoadLanguages(LanguageSet a_languages, const std::vector<StringFile>& a_files);
+
+	void                                              LoadLazyFiles(const std::vector<StringFile>& a_files);
+	static std::unique_ptr<LazySubtitleTable::Stream> OpenResourceStream(const std::string& a_path);
+
+	std::string ResolveSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, Language a_language) const;
 
 	// members
 	Language                      gameLanguage{ Language::kEnglish };
 	LanguageSetting<0x806, 0x807> primaryLanguage;
 	LanguageSetting<0x80A, 0x80B> secondaryLanguage;
-	SubtitleToIDMap               subtitleToID;
-	IDToSubtitleMap               idToSubtitle;
+	LocalizedTables               tables;
+	LazySubtitleTable             lazyTable{ OpenResourceStream };
+	StringFileIndex               stringFileIndex;
+	std::vector<StringFile>       stringFiles;  // every language, collected on the main thread since it looks up plugins
+	mutable Lock                  dataLock;
+	LanguageSet                   loadedLanguages;   // guarded by dataLock
+	LanguageSet                   loadingLanguages;  // main thread only
+	std::atomic<bool>             languagesLoaded{ false };
+	bool                          loadAllLanguages{ false };
+	bool                          lazyLoadStrings{ false };
+	bool                          readAllStringTables{ false };  // also read .STRINGS and .DLSTRINGS, dialogue only lives in .ILSTRINGS
+	std::mutex                    loaderLock;
+	std::condition_variable_any   loaderCondition;
+	LanguageSet                   pendingLanguages;  // guarded by loaderLock
+	std::jthread                  languageLoader;    // last, so it is stopped and joined before anything it uses goes away
 };
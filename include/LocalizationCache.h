@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Localization.h"
+
+// Binary snapshot of the merged localization tables, keyed by a fingerprint of the load order and STRINGS files
+class LocalizationCache
+{
+public:
+	using StringFile = LocalizedSubtitles::StringFile;
+	using LanguageSet = LocalizedSubtitles::LanguageSet;
+
+	LocalizationCache(std::uint64_t a_fingerprint);
+
+	bool Load(LocalizedSubtitles& a_subtitles) const;
+	void Save(const LocalizedSubtitles& a_subtitles) const;
+
+	static std::uint64_t GetFingerprint(Language a_gameLanguage, const std::vector<StringFile>& a_files, const StringFileIndex& a_index);
+	static LanguageSet   GetCachedLanguages();  // languages of the last saved cache, none if there is none
+
+private:
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t fingerprint;
+		std::uint32_t languages;  // LanguageSet the tables were loaded with
+	};
+
+	static std::filesystem::path GetPath();
+	static std::uint64_t         GetFileFingerprint(const StringFile& a_file, const StringFileIndex& a_index);
+
+	static constexpr std::uint32_t MAGIC = 0x434C5346;  // FSLC
+	static constexpr std::uint32_t VERSION = 5;
+
+	// members
+	std::filesystem::path path;
+	std::uint64_t         fingerprint;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+namespace RE
+{
+	// https://en.uesp.net/wiki/Tes5Mod:String_Table_File_Format
+	// Non-owning view over a .STRINGS, .DLSTRINGS or .ILSTRINGS buffer. Strings are returned as views into the buffer, which must outlive the table.
+	class LocalizedStringTable
+	{
+	public:
+		enum class Type
+		{
+			kStrings,    // null-terminated strings
+			kDLStrings,  // length-prefixed strings
+			kILStrings,  // length-prefixed strings
+
+			kTotal
+		};
+
+		struct DirectoryEntry
+		{
+			std::uint32_t stringID;  //	String ID
+			std::uint32_t offset;    //	Offset (relative to beginning of data) to the string.
+		};
+
+		static constexpr std::uint32_t headerSize = 8;
+
+		// a directory-only table needs just the header and directory, strings are then read separately at GetDataOffset() + offset
+		LocalizedStringTable(std::span<const std::byte> a_buffer, Type a_type, bool a_directoryOnly = false);
+
+		// size of header + directory, read from the first headerSize bytes
+		static std::optional<std::uint32_t> GetDirectoryEnd(std::span<const std::byte> a_header);
+		static std::string_view             GetExtension(Type a_type);
+		static bool                         IsLengthPrefixed(Type a_type) { return a_type != Type::kStrings; }
+
+		bool           IsValid() const { return valid; }
+		Type           GetType() const { return type; }
+		std::uint32_t  GetEntryCount() const { return entryCount; }
+		std::uint32_t  GetDataOffset() const { return headerSize + static_cast<std::uint32_t>(directory.size()); }
+		DirectoryEntry GetEntry(std::uint32_t a_index) const;
+
+		// returns an empty view if the offset or length runs past the data block
+		std::string_view GetStringAtOffset(std::uint32_t a_offset) const;
+
+		template <class F>
+		void ForEachString(F&& a_func) const
+		{
+			for (std::uint32_t i = 0; i < entryCount; ++i) {
+				const auto [stringID, offset] = GetEntry(i);
+				a_func(stringID, GetStringAtOffset(offset));
+			}
+		}
+
+	private:
+		// increments offset, returns false if out of bounds
+		static bool read_uint32(std::uint32_t& val, std::span<const std::byte> a_buffer, std::uint32_t& a_bufferPosition);
+
+		// members
+		std::uint32_t              entryCount{ 0 };  // Number of entries in the string table.
+		std::uint32_t              dataSize{ 0 };    // Size of string data that follows after header and directory.
+		std::span<const std::byte> directory;
+		std::span<const std::byte> data;
+		Type                       type;
+		bool                       valid{ false };
+	};
+}
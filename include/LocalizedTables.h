@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Language.h"
+#include "StringTableParser.h"
+#include "SubtitleTable.h"
+
+// The merged localization tables, built from parsed string tables or read back from the cache file.
+// Nothing here touches the game, so a cold build and a warm load can be measured headless.
+struct LocalizedTables
+{
+	using SubtitleID = SubtitleTable::SubtitleID;
+	using Row = SubtitleTable::Row;
+	using Table = StringTableParser::Table;
+
+	using AlternateRowMap = FlatMap<Row, std::vector<Row>>;  // indexed row -> rows of other ids sharing the same game language text
+	using TranslationMap = FlatMap<SubtitleID, FlatMap<Language, std::string_view>>;  // views into the parsed tables
+
+	// a_partials[i] is a table in a_languages[i], in load order. strings are only copied once, into the arenas.
+	// translations that are not valid UTF-8 are left out, the game's own line is shown instead of replacement characters
+	void Build(std::span<const Table> a_partials, std::span<const Language> a_languages, Language a_gameLanguage);
+	// languages loaded later, collected before the tables are locked. only valid translations of rows already built are
+	// kept, a_partials must outlive the map
+	static TranslationMap GetTranslations(std::span<const Table> a_partials, std::span<const Language> a_languages);
+	void                  AddTranslations(const TranslationMap& a_translations);
+
+	// the tables part of the cache file, the caller checks its own header first
+	void Write(std::ostream& a_stream) const;
+	// nothing is changed when the data is corrupt
+	bool Read(std::span<const std::byte> a_buffer);
+
+	// members
+	SubtitleTable   subtitleTable;
+	AlternateRowMap alternateRows;
+};
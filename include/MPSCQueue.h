@@ -0,0 +1,78 @@
+#pragma once
+
+// Lock-free multi-producer, single-consumer queue.
+// Producers push onto an intrusive stack with a single CAS, the consumer takes the whole stack at once and
+// reverses it to restore FIFO order. A waiting consumer is woken through a separate counter, so a stop request can
+// wake it without queueing anything.
+template <class T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() = default;
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	~MPSCQueue()
+	{
+		Consume([](T&&) {});
+	}
+
+	void Push(T a_value)
+	{
+		const auto node = new Node{ std::move(a_value), head.load(std::memory_order_relaxed) };
+		while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+		Wake();
+	}
+
+	// blocks the consumer until something is queued or a_token is stopped
+	void Wait(std::stop_token a_token)
+	{
+		const std::stop_callback onStop(a_token, [this] { Wake(); });
+
+		// the counter is read before the stack, a push or stop in between changes it and the wait returns at once
+		for (auto seen = wakeups.load(std::memory_order_acquire); !head.load(std::memory_order_acquire) && !a_token.stop_requested(); seen = wakeups.load(std::memory_order_acquire)) {
+			wakeups.wait(seen, std::memory_order_acquire);
+		}
+	}
+
+	template <class F>
+	std::size_t Consume(F&& a_func)
+	{
+		Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+		Node* fifo = nullptr;
+		while (node) {
+			const auto next = node->next;
+			node->next = fifo;
+			fifo = node;
+			node = next;
+		}
+
+		std::size_t count = 0;
+		while (fifo) {
+			a_func(std::move(fifo->value));
+			const auto next = fifo->next;
+			delete fifo;
+			fifo = next;
+			++count;
+		}
+		return count;
+	}
+
+private:
+	struct Node
+	{
+		T     value;
+		Node* next;
+	};
+
+	void Wake()
+	{
+		wakeups.fetch_add(1, std::memory_order_release);
+		wakeups.notify_one();
+	}
+
+	// members
+	std::atomic<Node*>         head{ nullptr };
+	std::atomic<std::uint32_t> wakeups{ 0 };
+};
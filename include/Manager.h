@@ -1,8 +1,14 @@
 #pragma once
 
+#include "BudgetCache.h"
 #include "Localization.h"
+#include "MPSCQueue.h"
 #include "RE.h"
+#include "RayCaster.h"
+#include "RaycastScheduler.h"
+#include "SnapshotPtr.h"
 #include "Subtitles.h"
+#include "VisibilityCache.h"
 
 class Manager :
 	public REX::Singleton<Manager>,
@@ -17,7 +23,7 @@ public:
 	bool SkipRender() const;
 	void Draw();
 
-	void AddSubtitle(RE::SubtitleManager* a_manager, const char* a_subtitle);
+	void AddSubtitle(RE::SubtitleManager* a_manager, const char* a_subtitle, const RE::TESTopicInfo* a_topicInfo);
 	bool UpdateSubtitleInfo(RE::SubtitleManager* a_manager);
 
 private:
@@ -36,22 +42,87 @@ private:
 		RE::Global<float, 0x80C> subtitleAlphaSecondary{ 1.0f };
 	};
 
+	using DualSubtitlePtr = std::shared_ptr<const DualSubtitle>;  // immutable once published, replaced as a whole on relayout
+
+	// subtitle text and LocalizedSubtitles::GetPluginKey, the same line can be translated differently by another plugin
+	using ProcessedSubtitleKey = std::pair<std::string, std::uint64_t>;
+
+	struct ProcessedSubtitle
+	{
+		const RE::TESTopicInfo* topicInfo;  // topic the subtitle was first seen with, reused when laying it out again
+		DualSubtitlePtr         subtitle;
+		std::uint64_t           generation{ 0 };  // layoutGeneration the subtitle was laid out with
+		bool                    relayoutQueued{ false };
+	};
+
+	// identical text shares one interned address, so the plugin key is needed to tell translations apart
+	using ProcessedSubtitleIndex = FlatMap<std::pair<const char*, std::uint64_t>, DualSubtitlePtr>;  // (interned subtitle text, plugin key) -> processed subtitle
+
+	struct LayoutJob
+	{
+		std::string             text;  // copied, the pool entry may be released before the worker gets to it
+		const char*             key;
+		const RE::TESTopicInfo* topicInfo;
+		bool                    heard{ true };                 // false when only laid out again, not counted as a cache lookup
+		std::uint32_t           pendingSlot{ noPendingSlot };  // released once the worker has published the line
+	};
+
+	// everything a layout depends on, replaced as a whole so the worker never reads settings while they are written
+	struct LayoutSettings
+	{
+		LayoutLanguage                           primary;
+		LayoutLanguage                           secondary;
+		bool                                     showDualSubs{ false };
+		std::shared_ptr<const GlyphAdvanceTable> advances;  // null until the first frame has built one
+	};
+
+	// code points a layout had no advances for, measured on the render thread before the line is laid out again
+	struct GlyphRequest
+	{
+		std::vector<char32_t> codePoints;
+		LayoutJob             job;
+	};
+
+	// power of two buckets in microseconds, the last one is open ended
+	struct LatencyHistogram
+	{
+		void        Record(std::chrono::steady_clock::duration a_duration);
+		std::string ToString() const;
+
+		std::array<std::atomic<std::uint32_t>, 12> buckets{};
+	};
+
+	static constexpr std::uint32_t noPendingSlot = std::numeric_limits<std::uint32_t>::max();
+
 	using SubtitleFlag = RE::SubtitleInfoEx::Flag;
-	using RWLock = std::shared_mutex;
-	using ReadLocker = std::shared_lock<RWLock>;
-	using WriteLocker = std::unique_lock<RWLock>;
+	using Lock = std::mutex;
+	using Locker = std::scoped_lock<Lock>;
 
 	bool                ShowGeneralSubtitles() const;
 	bool                ShowDialogueSubtitles() const;
-	DualSubtitle        CreateDualSubtitles(const char* subtitle) const;
-	void                AddProcessedSubtitle(const char* subtitle);
-	const DualSubtitle& GetProcessedSubtitle(const RE::BSFixedStringCS& a_subtitle);
-	void                RebuildProcessedSubtitles();
+	DualSubtitle        CreateDualSubtitles(const char* subtitle, const RE::TESTopicInfo* a_topicInfo, const LayoutSettings& a_settings) const;
+	template <class F>
+	void                UpdateLayoutSettings(F&& a_update);
+	void                UpdateGlyphAdvances();
+	std::uint32_t       ReservePendingSlot(const char* a_subtitle);
+	void                ReleasePendingSlot(std::uint32_t a_slot);
+	bool                IsPending(const char* a_subtitle) const;
+	void                StartLayoutWorker();
+	void                RunLayoutWorker(std::stop_token a_token);
+	void                QueueProcessedSubtitle(const char* a_subtitle, const RE::TESTopicInfo* a_topicInfo);
+	void                AddProcessedSubtitle(const LayoutJob& a_job);
+	void                PublishProcessedSubtitle(const char* a_key, std::uint64_t a_pluginKey, const DualSubtitlePtr& a_subtitle);
+	void                UnpublishProcessedSubtitle(const char* a_key);
+	DualSubtitlePtr     GetProcessedSubtitle(const RE::SubtitleInfoEx& a_subInfo);
+	void                InvalidateProcessedSubtitles();
+	void                PruneProcessedSubtitleIndex(const RE::BSTArray<RE::SubtitleInfoEx>& a_subtitleArray);
+	static bool         IsLive(const ProcessedSubtitleIndex& a_liveIndex, const ProcessedSubtitle& a_processedSub);
+	void                LogCacheStats() const;
 	RE::NiPoint3        CalculateSubtitleAnchorPos(const RE::SubtitleInfoEx& a_subInfo) const;
 	static RE::NiPoint3 GetSubtitleAnchorPosImpl(const RE::TESObjectREFRPtr& a_ref, float a_height);
 	void                CalculateAlphaModifier(RE::SubtitleInfoEx& a_subInfo) const;
-	void                CalculateVisibility(RE::SubtitleInfoEx& a_subInfo);
-	std::string         GetScaleformSubtitle(const RE::BSFixedStringCS& a_subtitle);
+	void                CalculateVisibility(RE::SubtitleInfoEx& a_subInfo, RayPicker& a_picker);
+	std::string         GetScaleformSubtitle(const RE::SubtitleInfoEx& a_subInfo);
 	void                ClearScaleformSubtitle(RE::BSTValueEventSource<RE::HUDSubtitleDisplayEvent>& a_event, std::string_view a_subtitle);
 	void                ClearScaleformSubtitle();
 
@@ -60,11 +131,26 @@ private:
 	RE::BSEventNotifyControl ProcessEvent(const RE::PlayerCrosshairModeEvent& a_event, RE::BSTEventSource<RE::PlayerCrosshairModeEvent>*) override;
 
 	// members
-	mutable RWLock                     subtitleLock;
-	FlatMap<std::string, DualSubtitle> processedSubtitles;
-	GlobalSettings                     settings;
-	float                              maxDistanceStartSq{ 4194304.0f };
-	float                              maxDistanceEndSq{ 4624220.16f };
-	LocalizedSubtitles                 localizedSubs;
-	std::uint32_t                      crosshairMode{ 0 };
+	Lock                                                 subtitleLock;  // writers only
+	BudgetCache<ProcessedSubtitleKey, ProcessedSubtitle> processedSubtitles{ 4096 * 1024 };  // guarded by subtitleLock, budget in bytes
+	SnapshotPtr<ProcessedSubtitleIndex>                  processedSubtitleIndex{ std::make_unique<const ProcessedSubtitleIndex>() };  // copy on write, published under subtitleLock, live pool entries only
+	std::atomic<std::uint64_t>                           cacheHits{ 0 };  // once per line heard, not per lookup
+	std::atomic<std::uint64_t>                           cacheMisses{ 0 };
+	std::uint64_t                                        layoutGeneration{ 0 };  // guarded by subtitleLock, bumped when settings change the layout
+	MPSCQueue<LayoutJob>                                 layoutQueue;
+	std::array<std::atomic<const char*>, 64>             pendingAddresses{};  // queued by the hook and not published yet, see QueueProcessedSubtitle
+	std::atomic<std::uint32_t>                           pendingCount{ 0 };
+	std::atomic<std::shared_ptr<const LayoutSettings>>   layoutSettings{ std::make_shared<const LayoutSettings>() };  // languages from the main thread, advances from the render thread
+	MPSCQueue<GlyphRequest>                              glyphRequests;
+	std::shared_ptr<const GlyphAdvanceTable>             glyphAdvances;     // render thread only, the last published table
+	std::optional<std::pair<ImGuiID, float>>             glyphAdvancesKey;  // render thread only, font id and size of glyphAdvances
+	LatencyHistogram                                     hookLatency;
+	VisibilityCache                                      visibilityCache;
+	RaycastScheduler                                     raycastScheduler;
+	GlobalSettings                                       settings;
+	float                                                maxDistanceStartSq{ 4194304.0f };
+	float                                                maxDistanceEndSq{ 4624220.16f };
+	LocalizedSubtitles                                   localizedSubs;
+	std::uint32_t                                        crosshairMode{ 0 };
+	std::jthread                                         layoutWorker;  // last, so it is stopped and joined before anything it uses goes away
 };
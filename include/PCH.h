@@ -9,9 +9,15 @@
 #include "RE/Fallout.h"
 #include "REX/REX/Singleton.h"
 
+#include <bitset>
+#include <condition_variable>
 #include <dxgi.h>
+#include <execution>
+#include <fstream>
 #include <shared_mutex>
 #include <shlobj.h>
+#include <stop_token>
+#include <thread>
 
 #include <ClibUtil/simpleINI.hpp>
 #include <ClibUtil/string.hpp>
@@ -19,6 +25,7 @@
 
 #include <boost_unordered.hpp>
 #include <freetype/freetype.h>
+#include <mmio/mmio.hpp>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <srell.hpp>
 #include <xbyak/xbyak.h>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "LocalizedStringTable.h"
+
 namespace RE
 {
 	using TESObjectREFRPtr = NiPointer<TESObjectREFR>;
@@ -28,29 +30,6 @@ namespace RE
 		return *map;
 	}
 
-	// https://en.uesp.net/wiki/Tes5Mod:String_Table_File_Format
-	struct ILStringTable
-	{
-		struct DirectoryEntry
-		{
-			std::uint32_t stringID;  //	String ID
-			std::uint32_t offset;    //	Offset (relative to beginning of data) to the string.
-		};
-
-		ILStringTable(const std::vector<std::byte>& a_buffer);
-		std::string GetStringAtOffset(std::uint32_t offset) const;
-
-		// members
-		std::uint32_t               entryCount;  // Number of entries in the string table.
-		std::uint32_t               dataSize;    // Size of string data that follows after header and directory.
-		std::vector<DirectoryEntry> directory;
-		std::vector<std::byte>      rawData;
-
-	private:
-		// increments offset
-		static void read_uint32(std::uint32_t& val, const std::vector<std::byte>& a_buffer, std::uint32_t& a_bufferPosition);
-	};
-
 	class SubtitleInfoEx
 	{
 	public:
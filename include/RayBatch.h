@@ -0,0 +1,57 @@
+#pragma once
+
+// Line of sight checks for several actors at once.
+// A query casts to the actor's eye, head, torso and feet in turn starting at firstPoint, until one reaches the actor
+// or maxRays were cast. Each actor is cast to completion in turn. Actors whose rays all fit the budget are grouped by
+// physics world so each world's rays are cast back to back, and the outcome is scattered back to each query.
+class RayBatch
+{
+public:
+	enum class Result
+	{
+		kOffscreen = 0,
+		kObscured,
+		kVisible
+	};
+
+	// what the batch casts into, RayPicker in game and a fake one in tests
+	class World
+	{
+	public:
+		virtual ~World() = default;
+
+		// null when the actor's cell is not attached
+		virtual RE::hknpBSWorld* GetPhysicsWorld(RE::Actor* a_actor) = 0;
+		// picks until the next call are made in a_world
+		virtual void BeginPicks(RE::hknpBSWorld* a_world) = 0;
+		// whether the ray from the camera to LOS point a_point reaches the actor
+		virtual bool Pick(RE::Actor* a_actor, std::uint32_t a_point) = 0;
+	};
+
+	struct Query
+	{
+		RE::Actor*    actor;
+		std::uint32_t firstPoint;
+		std::uint32_t maxRays;
+		Result        result{ Result::kObscured };
+		std::uint32_t rayCount{ 0 };
+		std::uint32_t nextPoint{ 0 };  // the visible point, or the first one not tried yet
+		bool          done{ false };   // false when the ray budget could not cover it, no ray was cast then
+	};
+
+	static constexpr std::uint32_t pointCount{ 4 };
+
+	void Add(RE::Actor* a_actor, std::uint32_t a_firstPoint, std::uint32_t a_maxRays);
+	// queries are served in the order they were added, the first one with a physics world always finishes.
+	// one is only started if its maxRays still fit, so every query is either finished or untouched
+	void Cast(World& a_world, std::uint32_t a_rayBudget);
+	void Clear();
+
+	std::span<const Query> GetQueries() const { return queries; }
+	std::uint32_t          GetRayCount() const { return rayCount; }
+
+private:
+	// members
+	std::vector<Query> queries;
+	std::uint32_t      rayCount{ 0 };
+};
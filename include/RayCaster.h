@@ -1,22 +1,35 @@
 #pragma once
 
+#include "RayBatch.h"
+
 class RayCollector : public RE::hknpClosestHitCollector
 {
 public:
+	// owners of the bodies hit so far, body ids are only unique within a world
+	using BodyOwnerCache = FlatMap<std::pair<const RE::hknpBSWorld*, std::uint32_t>, RE::TESObjectREFR*>;
+
 	RayCollector() {}
-	RayCollector(RE::Actor* a_actor, RE::hknpBSWorld* a_physicsWorld);
+	RayCollector(RE::Actor* a_actor, RE::hknpBSWorld* a_physicsWorld, BodyOwnerCache* a_bodyOwners = nullptr);
 	
 	void AddHit(const RE::hknpCollisionResult& a_result) override;  // 01
 
+	void SetActor(RE::Actor* a_actor) { actor = a_actor; }
+	void SetPhysicsWorld(RE::hknpBSWorld* a_physicsWorld) { physicsWorld = a_physicsWorld; }
+
 private:
+	RE::TESObjectREFR* GetOwner(RE::hknpBodyId a_bodyId) const;
+
 	// members
 	RE::Actor* actor;
 	RE::hknpBSWorld* physicsWorld;
+	BodyOwnerCache*  bodyOwners{ nullptr };
 };
 
 class RayCaster
 {
 public:
+	using Result = RayBatch::Result;
+
 	struct StartPoint
 	{
 		void Init();
@@ -25,24 +38,42 @@ public:
 		RE::NiPoint3 debug;
 	};
 
-	enum class Result
-	{
-		kOffscreen = 0,
-		kObscured,
-		kVisible
-	};
-
 	RayCaster() = default;
 	RayCaster(RE::Actor* a_target);
 
-	Result GetResult(bool a_debugRay);
+	// frustum and loaded cell checks only, no rays
+	bool IsOffscreen() const;
+
+	const RE::NiPoint3& GetCameraPos() const { return startPoint.camera; }
+
+	// null when the actor's cell is not attached
+	static RE::hknpBSWorld* GetPhysicsWorld(RE::Actor* a_actor);
 
 private:
-	void DebugRay(const RE::bhkPickData& a_pickData, RE::NiAVObject* a_obj, RE::TESObjectREFR* a_owner, const RE::NiPoint3& a_targetPos, ImU32 color) const;
+	// members
+	StartPoint startPoint;
+	RE::Actor* actor;
+};
 
+// The game world for RayBatch, picks through RE::TES from the camera of the frame it was made in.
+// One pick query and collector serve every ray, along with the body owners they resolve.
+class RayPicker : public RayBatch::World
+{
+public:
+	RayPicker();
+	RayPicker(const RayPicker&) = delete;
+	RayPicker& operator=(const RayPicker&) = delete;
+
+	RE::hknpBSWorld* GetPhysicsWorld(RE::Actor* a_actor) override;
+	void             BeginPicks(RE::hknpBSWorld* a_world) override;
+	bool             Pick(RE::Actor* a_actor, std::uint32_t a_point) override;
+
+	const RE::NiPoint3& GetCameraPos() const { return startPoint.camera; }
+
+private:
 	// members
-	StartPoint                  startPoint;
-	std::array<RE::NiPoint3, 4> targetPoints;
-	std::array<ImU32, 4>        debugColors{ 0xFF2626FF, 0xFF26FFD3, 0xFF7CFF26, 0xFFFF7C2 };
-	RE::Actor*                  actor;
+	RayCaster::StartPoint        startPoint;
+	RayCollector::BodyOwnerCache bodyOwners;  // a crowd hits the same bodies over and over
+	RayCollector                 collector;
+	RE::bhkPickData              pickData{};
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "VisibilityCache.h"
+
+// Spreads line of sight checks over several updates when many speakers need them at once.
+// Requests are ranked by time since the last check, distance and size on screen and cast as one batch until the
+// ray budget runs out, the rest are requested again next update, older and so ranked higher.
+class RaycastScheduler
+{
+public:
+	struct Request
+	{
+		RE::ObjectRefHandle speaker;
+		RE::Actor*          actor;
+		RE::NiPoint3        actorPos;
+		float               priority;
+		float               angularSize;
+	};
+
+	// radius over distance
+	static float GetAngularSize(const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_center, float a_radius);
+
+	static float GetPriority(VisibilityCache::Clock::duration a_age, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_center, float a_radius, float a_maxDistance);
+
+	// the result to show for a speaker the cache had nothing current for. it is queued for Run and its last result
+	// stands until then. a speaker without one, never checked or expired, is cast right away outside the budget so it
+	// is never drawn in a state no ray decided
+	RayBatch::Result Schedule(VisibilityCache& a_cache, RayBatch::World& a_world, const Request& a_request, const RE::NiPoint3& a_cameraPos);
+	// casts the highest ranked requests into the cache, called once per update under the subtitle manager lock
+	void Run(VisibilityCache& a_cache, RayBatch::World& a_world, const RE::NiPoint3& a_cameraPos);
+
+	std::uint32_t GetRayBudget() const { return rayBudget; }
+	void          SetRayBudget(std::uint32_t a_budget) { rayBudget = a_budget; }
+	std::uint64_t GetChecked() const { return checked; }
+	std::uint64_t GetFirstChecks() const { return firstChecks; }
+	std::uint64_t GetDeferred() const { return deferred; }
+	std::uint32_t GetMaxPending() const { return maxPending; }
+
+private:
+	static constexpr float smallAngularSize{ 0.03f };  // below this a speaker that was obscured is rechecked with one ray
+
+	// members
+	std::vector<Request> requests;
+	RayBatch             batch;
+	std::uint32_t        rayBudget{ 12 };  // at least one speaker is checked per update regardless
+	std::uint64_t        checked{ 0 };
+	std::uint64_t        firstChecks{ 0 };
+	std::uint64_t        deferred{ 0 };
+	std::uint32_t        maxPending{ 0 };
+};
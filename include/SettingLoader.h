@@ -2,7 +2,8 @@
 
 enum class FileType
 {
-	kFonts
+	kFonts,
+	kSettings
 };
 
 class SettingLoader
@@ -23,6 +24,7 @@ private:
 
 	// members
 	const wchar_t* fontsPath{ L"Data/Interface/FloatingSubtitles/fonts.ini" };
+	const wchar_t* settingsPath{ L"Data/F4SE/Plugins/po3_FloatingSubtitlesF4.ini" };
 
 	static SettingLoader instance;
 };
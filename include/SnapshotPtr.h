@@ -0,0 +1,109 @@
+#pragma once
+
+// Pointer to an immutable snapshot that readers use without locks or reference counting.
+// Writers, serialized by the caller, publish a replacement and retire the old snapshot. Readers count themselves in
+// under the parity of the current epoch, and a writer only moves to the next epoch once nobody is left under the
+// previous one. Snapshots retired during that previous epoch can then no longer be seen by anyone and are freed.
+// Only atomic pointers and counters are used, so reads never block even where std::atomic<std::shared_ptr> does.
+template <class T>
+class SnapshotPtr
+{
+public:
+	// keeps the snapshot it was created with alive. hold it briefly, nothing retired meanwhile is freed until it's gone
+	class Reader
+	{
+	public:
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		~Reader()
+		{
+			readers.fetch_sub(1, std::memory_order_release);
+		}
+
+		const T& operator*() const { return *snapshot; }
+		const T* operator->() const { return snapshot; }
+
+	private:
+		friend SnapshotPtr;
+
+		Reader(std::atomic<std::uint32_t>& a_readers, const T* a_snapshot) :
+			readers(a_readers),
+			snapshot(a_snapshot)
+		{}
+
+		// members
+		std::atomic<std::uint32_t>& readers;
+		const T*                    snapshot;
+	};
+
+	explicit SnapshotPtr(std::unique_ptr<const T> a_snapshot) :
+		current(a_snapshot.release())
+	{}
+
+	SnapshotPtr(const SnapshotPtr&) = delete;
+	SnapshotPtr& operator=(const SnapshotPtr&) = delete;
+
+	~SnapshotPtr()
+	{
+		delete current.load();
+		for (auto& snapshots : retired) {
+			for (const auto snapshot : snapshots) {
+				delete snapshot;
+			}
+		}
+	}
+
+	Reader Read() const
+	{
+		while (true) {
+			const auto epochValue = epoch.load();
+			auto&      count = readers[epochValue & 1];
+			count.fetch_add(1);
+			// the writer may have checked this parity before we counted ourselves in, then it has moved on
+			if (epoch.load() == epochValue) {
+				return Reader(count, current.load());
+			}
+			count.fetch_sub(1);
+		}
+	}
+
+	// writers only
+	const T& Get() const { return *current.load(std::memory_order_relaxed); }
+
+	void Publish(std::unique_ptr<const T> a_snapshot)
+	{
+		retired[epoch.load() & 1].push_back(current.exchange(a_snapshot.release()));
+
+		// twice, without readers around the snapshot just replaced is freed right away
+		if (TryAdvance()) {
+			TryAdvance();
+		}
+	}
+
+	std::size_t GetRetiredCount() const { return retired[0].size() + retired[1].size(); }
+
+private:
+	bool TryAdvance()
+	{
+		const auto next = epoch.load() + 1;
+		if (readers[next & 1].load() != 0) {
+			return false;
+		}
+
+		// retired during the previous epoch, every reader counted in since has loaded a newer snapshot
+		for (const auto snapshot : retired[next & 1]) {
+			delete snapshot;
+		}
+		retired[next & 1].clear();
+
+		epoch.store(next);
+		return true;
+	}
+
+	// members
+	std::atomic<const T*>                             current;
+	mutable std::atomic<std::uint32_t>                epoch{ 0 };
+	mutable std::array<std::atomic<std::uint32_t>, 2> readers{};
+	std::array<std::vector<const T*>, 2>              retired;  // by epoch parity
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// Set of string tables that actually exist, gathered once from loose files and archive name tables
+// so candidate paths can be filtered without opening a stream for each one.
+// Each table also gets a stamp from file sizes, write times and archive records, so changes can be detected without reading it.
+class StringFileIndex
+{
+public:
+	void Build();
+
+	bool        IsEmpty() const { return tables.empty(); }
+	std::size_t GetSize() const { return tables.size(); }
+	bool        Contains(std::string_view a_path) const;  // "STRINGS\\<plugin>_<lang>.<ext>", any case
+	// covers every copy of the table, loose or archived, nullopt when it isn't indexed
+	std::optional<std::uint64_t> GetStamp(std::string_view a_path) const;
+
+private:
+	static std::string Normalize(std::string_view a_path);
+
+	void AddLooseFiles();
+	void AddArchive(const std::filesystem::directory_entry& a_entry);
+	void AddTable(std::string_view a_path, std::uint64_t a_stamp);
+
+	// members
+	FlatMap<std::string, std::uint64_t> tables;  // lower case "strings\\<plugin>_<lang>.<ext>" -> stamp
+};
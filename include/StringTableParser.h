@@ -0,0 +1,30 @@
+#pragma once
+
+#include "LocalizedStringTable.h"
+#include "SubtitleTable.h"
+
+// Entries of a string table already read into memory, split from the game's file streams so parsing runs headless.
+// One table per task, LocalizedSubtitles::ParseStringFiles runs them on the worker pool.
+namespace StringTableParser
+{
+	using SubtitleID = SubtitleTable::SubtitleID;  // (mod index << 32) | string id
+	using Type = RE::LocalizedStringTable::Type;
+
+	struct Entry
+	{
+		SubtitleID       id;
+		std::string_view subtitle;  // into the parsed buffer
+	};
+
+	// a table read into memory and its entries. the buffer's storage moves with it, so the entries stay valid
+	struct Table
+	{
+		std::vector<std::byte> buffer;
+		std::vector<Entry>     entries;
+	};
+
+	inline SubtitleID GetSubtitleID(std::uint32_t a_modIndex, std::uint32_t a_stringID) { return (static_cast<SubtitleID>(a_modIndex) << 32) | a_stringID; }
+
+	// blank strings are left out, nullopt when the table is malformed. nothing is copied, a_buffer must outlive the entries
+	std::optional<std::vector<Entry>> Parse(std::span<const std::byte> a_buffer, Type a_type, std::uint32_t a_modIndex);
+}
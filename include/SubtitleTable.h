@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Language.h"
+
+// Compact storage for localized strings.
+// Each language owns one contiguous arena of null-terminated strings, and rows (one per string id) address it
+// through a dense id x language table of 32-bit offsets. The reverse index stores rows, not strings, so the
+// index language text is only kept once.
+class SubtitleTable
+{
+public:
+	using SubtitleID = std::uint64_t;
+	using Row = std::uint32_t;
+
+	static constexpr Row           invalidRow = std::numeric_limits<Row>::max();
+	static constexpr std::uint32_t invalidOffset = std::numeric_limits<std::uint32_t>::max();
+
+	SubtitleTable();
+	SubtitleTable(const SubtitleTable&) = delete;
+	SubtitleTable& operator=(const SubtitleTable&) = delete;
+
+	void Clear();
+	void ShrinkToFit();
+	void SetIndexLanguage(Language a_language) { indexLanguage = a_language; }
+
+	// returns the existing row if the id was already added
+	Row AddRow(SubtitleID a_id);
+	// another row for an id that already has one, when the id is indexed under more than one string. FindRow(a_id)
+	// keeps returning the first
+	Row AddDuplicateRow(SubtitleID a_id);
+	// keeps the first string set for a row and language
+	void SetString(Row a_row, Language a_language, std::string_view a_string);
+	// adds the row to the reverse index, keyed by its index language string
+	bool IndexRow(Row a_row);
+
+	std::size_t      GetRowCount() const { return ids.size(); }
+	std::size_t      GetIndexedCount() const { return reverseIndex.size(); }
+	SubtitleID       GetID(Row a_row) const { return ids[a_row]; }
+	Row              FindRow(SubtitleID a_id) const;
+	Row              FindRow(std::string_view a_string) const;
+	std::string_view GetString(Row a_row, Language a_language) const;
+
+	std::size_t GetMemoryUsage() const;
+
+private:
+	friend struct LocalizedTables;
+
+	struct Column
+	{
+		std::string                arena;
+		std::vector<std::uint32_t> offsets;
+	};
+
+	struct RowHash
+	{
+		using is_transparent = void;
+
+		std::size_t operator()(Row a_row) const { return (*this)(table->GetString(a_row, table->indexLanguage)); }
+		std::size_t operator()(std::string_view a_string) const { return std::hash<std::string_view>{}(a_string); }
+
+		const SubtitleTable* table{};
+	};
+
+	struct RowEqual
+	{
+		using is_transparent = void;
+
+		bool operator()(Row a_lhs, Row a_rhs) const { return a_lhs == a_rhs || get(a_lhs) == get(a_rhs); }
+		bool operator()(std::string_view a_lhs, Row a_rhs) const { return a_lhs == get(a_rhs); }
+		bool operator()(Row a_lhs, std::string_view a_rhs) const { return get(a_lhs) == a_rhs; }
+
+		std::string_view get(Row a_row) const { return table->GetString(a_row, table->indexLanguage); }
+
+		const SubtitleTable* table{};
+	};
+
+	using Columns = std::array<Column, std::to_underlying(Language::kTotal)>;
+
+	void Assign(std::vector<SubtitleID>&& a_ids, Columns&& a_columns, std::span<const Row> a_indexedRows);
+
+	// members
+	Language                        indexLanguage{ Language::kEnglish };
+	std::vector<SubtitleID>         ids;
+	FlatMap<SubtitleID, Row>        idToRow;
+	Columns                         columns;
+	FlatSet<Row, RowHash, RowEqual> reverseIndex;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Localization.h"
+#include "TextLayout.h"
 
 namespace ImGui
 {
@@ -9,27 +10,27 @@ namespace ImGui
 
 struct Subtitle
 {
-	struct Line
-	{
-		std::string line;
-		ImVec2      lineSize;
-	};
+	using Line = TextLayout::Line;
 
 	Subtitle() = default;
-	Subtitle(const LocalizedSubtitle& a_subtitle);
+	// safe off the game and render threads, a null table leaves the text on one line measured when it is drawn
+	Subtitle(const LocalizedSubtitle& a_subtitle, const GlyphAdvanceTable* a_advances);
 
-	void DrawSubtitle(float a_posX, float& a_posY, float a_alpha, float a_lineHeight) const;
+	void        DrawSubtitle(float a_posX, float& a_posY, float a_alpha, float a_lineHeight) const;
+	// no lines draws the text on one line, measured now
+	static void DrawSubtitle(std::string_view a_text, std::span<const Line> a_lines, float a_posX, float& a_posY, float a_alpha, float a_lineHeight);
+	bool        IsValidForScaleform() const;  // game thread only
+	std::size_t GetMemoryUsage() const;
 
-	std::vector<Line> lines;
-	std::string       fullLine;
-	bool              validForScaleform{ false };
+	bool             empty() const { return wrappedText.empty(); }
+	std::string_view GetText() const { return wrappedText.GetText(); }
 
 private:
-	static std::vector<Line> WrapText(const LocalizedSubtitle& a_subtitle);
-	static void              WrapCJKText(std::vector<Line>& lines, const std::string& text, std::uint32_t maxLineWidth);
-	static void              WrapLatinText(std::vector<Line>& lines, const std::string& text, std::uint32_t maxLineWidth);
-	static std::uint8_t      GetUTF8CharLength(const std::string& str, std::size_t pos);
-	static bool              IsTextCJK(const std::string& str);
+	static TextLayout::WrappedText WrapText(const LocalizedSubtitle& a_subtitle, const GlyphAdvanceTable* a_advances);
+
+	// members
+	TextLayout::WrappedText     wrappedText;
+	mutable std::optional<bool> validForScaleform;  // checked the first time the subtitle goes to the HUD
 };
 
 struct DualSubtitle
@@ -44,11 +45,14 @@ struct DualSubtitle
 	};
 
 	DualSubtitle() = default;
-	DualSubtitle(const LocalizedSubtitle& a_primarySubtitle);
-	DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const LocalizedSubtitle& a_secondarySubtitle);
+	DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const GlyphAdvanceTable* a_advances);
+	DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const LocalizedSubtitle& a_secondarySubtitle, const GlyphAdvanceTable* a_advances);
 
 	void        DrawDualSubtitle(const ScreenParams& a_screenParams) const;
+	// the game's text on one line, for a subtitle not laid out yet. nothing is copied
+	static void DrawUnprocessed(std::string_view a_text, const ScreenParams& a_screenParams);
 	std::string GetScaleformCompatibleSubtitle(bool a_dualSubs) const;
+	std::size_t GetMemoryUsage() const;
 
 	// members
 	Subtitle primary{};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Language.h"
+
+// Advance widths of one font at one size, so lines can be wrapped against a pixel width without measuring them afterwards.
+// Only printable ASCII is measured up front. Measuring a glyph bakes it into the font atlas, so anything else is measured
+// on the thread that owns the font once a subtitle uses it, into a new table. Tables never change once built, the layout
+// worker only reads them. Blocks where every glyph has the same width (ideographs, hangul) are measured once.
+class GlyphAdvanceTable
+{
+public:
+	using Source = std::function<float(char32_t)>;
+
+	GlyphAdvanceTable(const Source& a_source, float a_fontSize);
+	// a_base with a_codePoints measured as well
+	GlyphAdvanceTable(const GlyphAdvanceTable& a_base, std::span<const char32_t> a_codePoints, const Source& a_source);
+
+	float GetAdvance(char32_t a_codePoint) const;  // the fallback width until the code point is measured
+	bool  Contains(char32_t a_codePoint) const;
+	// adds the code points of a_text that are not measured yet
+	void  GetMissing(std::string_view a_text, FlatSet<char32_t>& a_missing) const;
+	float GetFontSize() const { return fontSize; }
+	float GetAverageAdvance() const { return averageAdvance; }  // mean of 'a'-'z', turns character counts into widths
+
+private:
+	// the first code point of its uniform block, or the code point itself
+	static char32_t GetKey(char32_t a_codePoint);
+
+	// members
+	float                    fontSize;
+	float                    averageAdvance{ 0.0f };
+	float                    fallbackAdvance{ 0.0f };
+	std::array<float, 128>   ascii{};
+	FlatMap<char32_t, float> other;  // by GetKey
+};
+
+namespace TextLayout
+{
+	// span of the wrapped text, so wrapping never copies it
+	struct Line
+	{
+		std::uint32_t offset;
+		std::uint32_t length;
+		float         width;
+	};
+
+	// returns U+FFFD and skips one byte on malformed input
+	char32_t DecodeUTF8(std::string_view a_text, std::size_t& a_pos);
+
+	// layout policy, each gets its own specialization of the wrapping loop
+	enum class Script
+	{
+		kLatin,
+		kCyrillic,
+		kCJK,
+		kJapanese  // strict kinsoku
+	};
+
+	// from the language alone, for text read from that language's string tables
+	Script GetScript(Language a_language);
+	// the game's own text, untranslated mod strings can be in any script so CJK is looked for
+	Script GetScript(Language a_language, std::string_view a_text);
+
+	// the setting stays in characters. text with no more code points than a_maxChars is only broken where it has to
+	// be, longer text is wrapped against the width of that many average characters
+	float GetMaxWidth(std::string_view a_text, std::uint32_t a_maxChars, const GlyphAdvanceTable& a_advances);
+
+	// single pass over the text, breaking only where UAX #14 allows it. valid UTF-8 is decoded unchecked, anything else
+	// as DecodeUTF8 does. lines are returned top to bottom, text with no break opportunity wider than a_maxWidth is split
+	// between characters
+	std::vector<Line> Wrap(Script a_script, std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances);
+	// into a_lines, cleared first, so a caller wrapping many texts keeps its capacity
+	void              Wrap(Script a_script, std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances, std::vector<Line>& a_lines);
+
+	// a copy of the text and its lines in a single allocation, lines first
+	class WrappedText
+	{
+	public:
+		WrappedText() = default;
+		WrappedText(std::string_view a_text, std::span<const Line> a_lines);
+
+		bool                  empty() const { return textLength == 0; }
+		std::string_view      GetText() const;   // null terminated
+		std::span<const Line> GetLines() const;  // top to bottom
+		std::size_t           GetMemoryUsage() const;
+
+	private:
+		// members
+		std::unique_ptr<Line[]> storage;
+		std::uint32_t           lineCount{ 0 };
+		std::uint32_t           textLength{ 0 };
+	};
+}
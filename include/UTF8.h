@@ -0,0 +1,26 @@
+#pragma once
+
+// Whole-string UTF-8 checks, vectorized over 32 (AVX2) or 16 (SSE4.2) bytes with an 8-byte SWAR fallback.
+// The kernel is picked once from CPUID, so the build needs no /arch flag to use AVX2 where the CPU has it.
+namespace UTF8
+{
+	enum class Kernel
+	{
+		kSWAR,
+		kSSE42,
+		kAVX2
+	};
+
+	bool IsASCII(std::string_view a_text);
+	// rejects overlong forms, surrogates, code points past U+10FFFF and truncated sequences
+	bool IsValid(std::string_view a_text);
+	// exact for valid text, otherwise the number of bytes that are not continuation bytes
+	std::size_t CountCodePoints(std::string_view a_text);
+	// kana, CJK ideographs and hangul, used to pick a layout when the language does not say
+	bool ContainsCJK(std::string_view a_text);
+
+	bool   IsSupported(Kernel a_kernel);
+	Kernel GetKernel();
+	// for tests and benchmarks, the kernel must be supported
+	void   SetKernel(Kernel a_kernel);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "RayBatch.h"
+
+// Line of sight per speaker, reused until the camera or the speaker moves far enough or the result gets old.
+// A changed result is only taken once the next cast agrees, so a single stray ray cannot make a subtitle flicker.
+// Only touched from UpdateSubtitleInfo, under the subtitle manager lock.
+class VisibilityCache
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// nullopt when the speaker needs new rays
+	std::optional<RayBatch::Result> Get(RE::ObjectRefHandle a_speaker, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_actorPos, Clock::time_point a_now);
+	// last result regardless of age, used while a new check is waiting for its turn
+	std::optional<RayBatch::Result> GetLast(RE::ObjectRefHandle a_speaker) const;
+	// LOS point the next cast starts at, see RayBatch::Query
+	std::uint32_t GetNextPoint(RE::ObjectRefHandle a_speaker) const;
+	// time since the last cast, max for speakers never checked
+	Clock::duration GetAge(RE::ObjectRefHandle a_speaker, Clock::time_point a_now) const;
+	// stores a finished check, returns the result after hysteresis
+	RayBatch::Result Update(RE::ObjectRefHandle a_speaker, const RayBatch::Query& a_query, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_actorPos, Clock::time_point a_now);
+	// every ray cast by a batch
+	void RecordRays(std::uint32_t a_count);
+	// drops speakers that have not been checked for a while and rolls the raycast rate over
+	void Prune(Clock::time_point a_now);
+
+	std::size_t   GetSize() const { return entries.size(); }
+	std::uint64_t GetHits() const { return hits; }
+	std::uint64_t GetCasts() const { return casts; }
+	std::uint64_t GetRays() const { return rays; }
+	float         GetRaysPerSecond() const { return raysPerSecond; }
+
+	static constexpr auto ttl{ std::chrono::milliseconds(250) };
+
+private:
+	struct Entry
+	{
+		RayBatch::Result result;   // what is shown
+		RayBatch::Result pending;  // last cast when it disagreed with result, equal otherwise
+		Clock::time_point lastCast;
+		RE::NiPoint3      cameraPos;
+		RE::NiPoint3      actorPos;
+		std::uint32_t     nextPoint;
+	};
+
+	static constexpr float cameraThresholdSq{ 16.0f * 16.0f };  // game units
+	static constexpr float actorThresholdSq{ 8.0f * 8.0f };
+	static constexpr auto  expiry{ std::chrono::seconds(2) };
+	static constexpr auto  rateWindow{ std::chrono::seconds(1) };
+
+	// members
+	FlatMap<std::uint32_t, Entry> entries;  // ObjectRefHandle native handle
+	std::uint64_t                 hits{ 0 };
+	std::uint64_t                 casts{ 0 };
+	std::uint64_t                 rays{ 0 };
+	std::uint32_t                 windowRays{ 0 };
+	Clock::time_point             windowStart{};
+	float                         raysPerSecond{ 0.0f };
+};
@@ -0,0 +1,19 @@
+#include "DuplicateSubtitles.h"
+
+DuplicateSubtitles::SubtitleID DuplicateSubtitles::PickBestID(const FlatSet<SubtitleID>& a_ids) const
+{
+	SubtitleID best = *a_ids.begin();
+
+	std::size_t bestCount = std::numeric_limits<std::size_t>::max();
+	std::size_t bestTotalLen = 0;
+
+	for (SubtitleID id : a_ids) {
+		const auto& [count, totalLen, languages] = idStats.at(id);
+		if (count < bestCount || (count == bestCount && totalLen > bestTotalLen)) {
+			best = id;
+			bestCount = count;
+			bestTotalLen = totalLen;
+		}
+	}
+	return best;
+}
@@ -10,7 +10,7 @@ namespace Hooks
 		{
 			func(a_manager, speaker, subtitleText, topicInfo, spokenToPlayer);
 
-			Manager::GetSingleton()->AddSubtitle(a_manager, subtitleText.c_str());
+			Manager::GetSingleton()->AddSubtitle(a_manager, subtitleText.c_str(), topicInfo);
 		}
 		static inline REL::Relocation<decltype(thunk)> func;
 	};
@@ -0,0 +1,57 @@
+#include "Language.h"
+
+std::string to_string(Language lang)
+{
+	switch (lang) {
+	case Language::kChinese:
+		return "CN";
+	case Language::kGerman:
+		return "DE";
+	case Language::kSpanish:
+		return "ES";
+	case Language::kLatinAmericanSpanish:
+		return "ESMX";
+	case Language::kFrench:
+		return "FR";
+	case Language::kItalian:
+		return "IT";
+	case Language::kJapanese:
+		return "JA";
+	case Language::kPolish:
+		return "PL";
+	case Language::kPortuguese:
+		return "PTBR";
+	case Language::kRussian:
+		return "RUS";
+	default:
+		return "EN";
+	}
+}
+
+Language to_language(std::string_view string)
+{
+	switch (string::const_hash(string)) {
+	case "CN"_h:
+		return Language::kChinese;
+	case "DE"_h:
+		return Language::kGerman;
+	case "ES"_h:
+		return Language::kSpanish;
+	case "ESMX"_h:
+		return Language::kLatinAmericanSpanish;
+	case "FR"_h:
+		return Language::kFrench;
+	case "IT"_h:
+		return Language::kItalian;
+	case "JA"_h:
+		return Language::kJapanese;
+	case "PL"_h:
+		return Language::kPolish;
+	case "PTBR"_h:
+		return Language::kPortuguese;
+	case "RUS"_h:
+		return Language::kRussian;
+	default:
+		return Language::kEnglish;
+	}
+}
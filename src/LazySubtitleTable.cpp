@@ -0,0 +1,270 @@
+#include "LazySubtitleTable.h"
+
+#include "UTF8.h"
+
+std::optional<LazySubtitleTable::File> LazySubtitleTable::ReadFile(const std::string& a_path, RE::LocalizedStringTable::Type a_type, bool a_hashStrings) const
+{
+	const auto stream = open(a_path);
+	if (!stream || stream->GetSize() < RE::LocalizedStringTable::headerSize || stream->GetSize() > std::numeric_limits<std::uint32_t>::max()) {
+		return std::nullopt;
+	}
+
+	std::vector<std::byte> buffer;  // not kept per pool thread, it would pin the largest table each thread ever read
+
+	// index language tables are hashed in full, everything else only needs the header and directory
+	if (a_hashStrings) {
+		buffer.resize(stream->GetSize());
+		stream->Read(buffer.data(), static_cast<std::uint32_t>(buffer.size()));
+	} else {
+		buffer.resize(RE::LocalizedStringTable::headerSize);
+		stream->Read(buffer.data(), RE::LocalizedStringTable::headerSize);
+
+		const auto directoryEnd = RE::LocalizedStringTable::GetDirectoryEnd(buffer);
+		if (!directoryEnd || *directoryEnd > stream->GetSize()) {
+			logger::warn("{} is malformed, skipping", a_path);
+			return std::nullopt;
+		}
+
+		buffer.resize(*directoryEnd);
+		stream->Read(buffer.data() + RE::LocalizedStringTable::headerSize, *directoryEnd - RE::LocalizedStringTable::headerSize);
+	}
+
+	const RE::LocalizedStringTable stringTable(buffer, a_type, !a_hashStrings);
+	if (!stringTable.IsValid()) {
+		logger::warn("{} is malformed, skipping", a_path);
+		return std::nullopt;
+	}
+
+	File file;
+	file.path = a_path;
+	file.type = a_type;
+	file.dataOffset = stringTable.GetDataOffset();
+	file.directory.reserve(stringTable.GetEntryCount());
+
+	for (std::uint32_t i = 0; i < stringTable.GetEntryCount(); ++i) {
+		const auto [stringID, offset] = stringTable.GetEntry(i);
+		file.directory.emplace(stringID, offset);
+	}
+
+	if (a_hashStrings) {
+		file.hashes.reserve(stringTable.GetEntryCount());
+		stringTable.ForEachString([&](std::uint32_t a_stringID, std::string_view a_str) {
+			if (!a_str.empty() && !string::is_only_space(a_str)) {
+				file.hashes.emplace_back(HashString(a_str), a_stringID);
+			}
+		});
+	}
+
+	return file;
+}
+
+void LazySubtitleTable::Clear()
+{
+	files.clear();
+	reverseIndex.clear();
+	alternateIDs.clear();
+
+	std::scoped_lock locker(cacheLock);
+	cache.clear();
+	cacheMap.clear();
+	streams.clear();
+}
+
+void LazySubtitleTable::AddFile(std::uint32_t a_modIndex, Language a_language, File&& a_file)
+{
+	if (a_language == indexLanguage) {
+		for (const auto& [hash, stringID] : a_file.hashes) {
+			const auto id = (static_cast<SubtitleID>(a_modIndex) << 32) | stringID;
+			if (const auto [it, inserted] = reverseIndex.try_emplace(hash, id); !inserted && it->second != id) {
+				if (auto& alternates = alternateIDs[hash]; std::ranges::find(alternates, id) == alternates.end()) {
+					alternates.push_back(id);
+				}
+			}
+		}
+	}
+	a_file.hashes = {};
+
+	const auto key = GetFileKey(a_modIndex, a_language, a_file.type);
+	{
+		std::scoped_lock locker(cacheLock);
+		std::erase_if(streams, [&](const OpenStream& a_stream) { return a_stream.fileKey == key; });
+	}
+	files.insert_or_assign(key, std::move(a_file));
+}
+
+std::optional<LazySubtitleTable::SubtitleID> LazySubtitleTable::FindID(std::string_view a_string, std::span<const std::uint32_t> a_preferredMods) const
+{
+	const auto hash = HashString(a_string);
+	const auto it = reverseIndex.find(hash);
+	if (it == reverseIndex.end()) {
+		return std::nullopt;
+	}
+
+	std::vector<SubtitleID> candidates{ it->second };
+	if (const auto altIt = alternateIDs.find(hash); altIt != alternateIDs.end()) {
+		candidates.insert(candidates.end(), altIt->second.begin(), altIt->second.end());
+	}
+
+	// only the hash was kept, the string itself is read back to rule out a collision or a changed file
+	const auto matches = [&](SubtitleID a_id) {
+		return GetString(a_id, indexLanguage) == a_string;
+	};
+
+	for (const auto modIndex : a_preferredMods) {
+		for (const auto id : candidates) {
+			if (GetModIndex(id) == modIndex && matches(id)) {
+				return id;
+			}
+		}
+	}
+
+	if (const auto match = std::ranges::find_if(candidates, matches); match != candidates.end()) {
+		return *match;
+	}
+	return std::nullopt;
+}
+
+std::optional<std::string> LazySubtitleTable::GetString(SubtitleID a_id, Language a_language) const
+{
+	const auto key = GetCacheKey(a_id, a_language);
+
+	std::scoped_lock locker(cacheLock);
+
+	if (const auto it = cacheMap.find(key); it != cacheMap.end()) {
+		cache.splice(cache.begin(), cache, it->second);
+		return it->second->second;
+	}
+
+	auto string = ReadString(a_id, a_language);
+	if (!string) {
+		return std::nullopt;
+	}
+
+	cache.emplace_front(key, *string);
+	cacheMap.emplace(key, cache.begin());
+
+	if (cache.size() > maxCachedStrings) {
+		cacheMap.erase(cache.back().first);
+		cache.pop_back();
+	}
+
+	return string;
+}
+
+std::optional<std::string> LazySubtitleTable::ReadString(SubtitleID a_id, Language a_language) const
+{
+	using Type = RE::LocalizedStringTable::Type;
+
+	const auto modIndex = GetModIndex(a_id);
+	const auto stringID = static_cast<std::uint32_t>(a_id);
+
+	// string ids are unique per plugin across all three table types
+	for (const auto type : { Type::kStrings, Type::kDLStrings, Type::kILStrings }) {
+		const auto key = GetFileKey(modIndex, a_language, type);
+		const auto fileIt = files.find(key);
+		if (fileIt == files.end()) {
+			continue;
+		}
+
+		const auto& file = fileIt->second;
+		if (const auto offsetIt = file.directory.find(stringID); offsetIt != file.directory.end()) {
+			const auto stream = GetStream(key, file);
+			auto       string = stream ? ReadString(*stream->stream, file, offsetIt->second) : std::nullopt;
+			// translations are left out unless valid UTF-8, like the eager tables do
+			if (string && a_language != indexLanguage && !UTF8::IsValid(*string)) {
+				return std::nullopt;
+			}
+			return string;
+		}
+	}
+
+	return std::nullopt;
+}
+
+LazySubtitleTable::OpenStream* LazySubtitleTable::GetStream(std::uint64_t a_fileKey, const File& a_file) const
+{
+	if (const auto it = std::ranges::find(streams, a_fileKey, &OpenStream::fileKey); it != streams.end()) {
+		streams.splice(streams.begin(), streams, it);
+		return &streams.front();
+	}
+
+	auto stream = open(a_file.path);
+	if (!stream) {
+		return nullptr;
+	}
+
+	streams.push_front({ a_fileKey, std::move(stream) });
+	if (streams.size() > maxOpenStreams) {
+		streams.pop_back();
+	}
+
+	return &streams.front();
+}
+
+std::optional<std::string> LazySubtitleTable::ReadString(Stream& a_stream, const File& a_file, std::uint32_t a_offset)
+{
+	const auto size = a_stream.GetSize();
+	const auto position = static_cast<std::uint64_t>(a_file.dataOffset) + a_offset;
+	if (position >= size) {
+		return std::nullopt;
+	}
+
+	a_stream.Seek(position);
+
+	if (!RE::LocalizedStringTable::IsLengthPrefixed(a_file.type)) {
+		// null-terminated, read in chunks until the terminator shows up
+		std::string string;
+		char        chunk[256];
+
+		auto remaining = size - position;
+		while (remaining > 0) {
+			const auto chunkSize = static_cast<std::uint32_t>(std::min<std::uint64_t>(remaining, sizeof(chunk)));
+			a_stream.Read(chunk, chunkSize);
+			remaining -= chunkSize;
+
+			const std::string_view view(chunk, chunkSize);
+			if (const auto end = view.find('\0'); end != std::string_view::npos) {
+				string.append(view.substr(0, end));
+				return string;
+			}
+			string.append(view);
+		}
+		return std::nullopt;
+	}
+
+	if (position + sizeof(std::uint32_t) > size) {
+		return std::nullopt;
+	}
+
+	std::uint32_t length;
+	a_stream.Read(&length, sizeof(length));
+	if (length == 0 || length > size - position - sizeof(std::uint32_t)) {
+		return std::nullopt;
+	}
+
+	std::string string(length, '\0');
+	a_stream.Read(string.data(), length);
+	string.resize(length - 1);  // drop null terminator
+
+	return string;
+}
+
+std::size_t LazySubtitleTable::GetMemoryUsage() const
+{
+	std::size_t size = files.bucket_count() * (sizeof(decltype(files)::value_type) + 1);
+	size += reverseIndex.bucket_count() * (sizeof(decltype(reverseIndex)::value_type) + 1);
+	size += alternateIDs.bucket_count() * (sizeof(decltype(alternateIDs)::value_type) + 1);
+	for (const auto& [hash, alternates] : alternateIDs) {
+		size += alternates.capacity() * sizeof(SubtitleID);
+	}
+	for (const auto& [key, file] : files) {
+		size += file.path.capacity() + file.directory.bucket_count() * (sizeof(decltype(file.directory)::value_type) + 1);
+	}
+
+	std::scoped_lock locker(cacheLock);
+	for (const auto& [cacheKey, string] : cache) {
+		size += sizeof(CacheList::value_type) + string.capacity();
+	}
+	size += streams.size() * sizeof(OpenStream);  // plus whatever the streams hold, they are capped at maxOpenStreams
+	return size;
+}
@@ -0,0 +1,466 @@
+#include "LineBreak.h"
+
+namespace LineBreak
+{
+	namespace
+	{
+		struct Range
+		{
+			char32_t first;
+			char32_t last;
+			Class    cls;
+		};
+
+		// sorted, non-overlapping, everything not listed is AL
+		// https://www.unicode.org/Public/UCD/latest/ucd/LineBreak.txt
+		constexpr auto ranges = std::to_array<Range>({
+			{ 0x0009, 0x0009, Class::kBA },
+			{ 0x000A, 0x000A, Class::kLF },
+			{ 0x000B, 0x000C, Class::kBK },
+			{ 0x000D, 0x000D, Class::kCR },
+			{ 0x0020, 0x0020, Class::kSP },
+			{ 0x0021, 0x0021, Class::kEX },
+			{ 0x0022, 0x0022, Class::kQU },
+			{ 0x0024, 0x0024, Class::kPR },
+			{ 0x0025, 0x0025, Class::kPO },
+			{ 0x0027, 0x0027, Class::kQU },
+			{ 0x0028, 0x0028, Class::kOP },
+			{ 0x0029, 0x0029, Class::kCP },
+			{ 0x002B, 0x002B, Class::kPR },
+			{ 0x002C, 0x002C, Class::kIS },
+			{ 0x002D, 0x002D, Class::kHY },
+			{ 0x002E, 0x002E, Class::kIS },
+			{ 0x002F, 0x002F, Class::kSY },
+			{ 0x0030, 0x0039, Class::kNU },
+			{ 0x003A, 0x003B, Class::kIS },
+			{ 0x003F, 0x003F, Class::kEX },
+			{ 0x005B, 0x005B, Class::kOP },
+			{ 0x005C, 0x005C, Class::kPR },
+			{ 0x005D, 0x005D, Class::kCP },
+			{ 0x007B, 0x007B, Class::kOP },
+			{ 0x007C, 0x007C, Class::kBA },
+			{ 0x007D, 0x007D, Class::kCL },
+			{ 0x0085, 0x0085, Class::kBK },
+			{ 0x00A0, 0x00A0, Class::kGL },
+			{ 0x00A1, 0x00A1, Class::kOP },
+			{ 0x00A2, 0x00A2, Class::kPO },
+			{ 0x00A3, 0x00A5, Class::kPR },
+			{ 0x00AB, 0x00AB, Class::kQU },
+			{ 0x00AD, 0x00AD, Class::kBA },
+			{ 0x00B0, 0x00B0, Class::kPO },
+			{ 0x00B1, 0x00B1, Class::kPR },
+			{ 0x00B4, 0x00B4, Class::kBB },
+			{ 0x00BB, 0x00BB, Class::kQU },
+			{ 0x00BF, 0x00BF, Class::kOP },
+			{ 0x0300, 0x036F, Class::kCM },
+			{ 0x0483, 0x0489, Class::kCM },
+			{ 0x0591, 0x05BD, Class::kCM },
+			{ 0x0610, 0x061A, Class::kCM },
+			{ 0x064B, 0x065F, Class::kCM },
+			// Thai is SA, which needs a dictionary. Without one break between syllables: consonants act as ID,
+			// preposed vowels never end a line and following vowels never start one
+			{ 0x0E01, 0x0E2E, Class::kID },
+			{ 0x0E2F, 0x0E30, Class::kNS },
+			{ 0x0E31, 0x0E31, Class::kCM },
+			{ 0x0E32, 0x0E33, Class::kNS },
+			{ 0x0E34, 0x0E3A, Class::kCM },
+			{ 0x0E3F, 0x0E3F, Class::kPR },
+			{ 0x0E40, 0x0E44, Class::kBB },
+			{ 0x0E45, 0x0E46, Class::kNS },
+			{ 0x0E47, 0x0E4E, Class::kCM },
+			{ 0x0E50, 0x0E59, Class::kNU },
+			{ 0x0E5A, 0x0E5B, Class::kBA },
+			{ 0x1100, 0x11FF, Class::kID },
+			{ 0x1AB0, 0x1AFF, Class::kCM },
+			{ 0x1DC0, 0x1DFF, Class::kCM },
+			{ 0x2000, 0x2006, Class::kBA },
+			{ 0x2007, 0x2007, Class::kGL },
+			{ 0x2008, 0x200A, Class::kBA },
+			{ 0x200B, 0x200B, Class::kZW },
+			{ 0x200C, 0x200D, Class::kCM },
+			{ 0x2010, 0x2010, Class::kBA },
+			{ 0x2011, 0x2011, Class::kGL },
+			{ 0x2012, 0x2014, Class::kBA },
+			{ 0x2018, 0x2019, Class::kQU },
+			{ 0x201A, 0x201A, Class::kOP },
+			{ 0x201C, 0x201D, Class::kQU },
+			{ 0x201E, 0x201E, Class::kOP },
+			{ 0x2024, 0x2026, Class::kIN },
+			{ 0x2027, 0x2027, Class::kBA },
+			{ 0x2028, 0x2029, Class::kBK },
+			{ 0x202F, 0x202F, Class::kGL },
+			{ 0x2030, 0x2037, Class::kPO },
+			{ 0x2039, 0x203A, Class::kQU },
+			{ 0x203C, 0x203D, Class::kNS },
+			{ 0x2044, 0x2044, Class::kIS },
+			{ 0x2060, 0x2060, Class::kWJ },
+			{ 0x20A0, 0x20CF, Class::kPR },
+			{ 0x20D0, 0x20FF, Class::kCM },
+			{ 0x2E80, 0x2FFF, Class::kID },
+			{ 0x3000, 0x3000, Class::kBA },
+			{ 0x3001, 0x3002, Class::kCL },
+			{ 0x3003, 0x3004, Class::kID },
+			{ 0x3005, 0x3005, Class::kNS },
+			{ 0x3006, 0x3007, Class::kID },
+			{ 0x3008, 0x3008, Class::kOPW },
+			{ 0x3009, 0x3009, Class::kCL },
+			{ 0x300A, 0x300A, Class::kOPW },
+			{ 0x300B, 0x300B, Class::kCL },
+			{ 0x300C, 0x300C, Class::kOPW },
+			{ 0x300D, 0x300D, Class::kCL },
+			{ 0x300E, 0x300E, Class::kOPW },
+			{ 0x300F, 0x300F, Class::kCL },
+			{ 0x3010, 0x3010, Class::kOPW },
+			{ 0x3011, 0x3011, Class::kCL },
+			{ 0x3012, 0x3013, Class::kID },
+			{ 0x3014, 0x3014, Class::kOPW },
+			{ 0x3015, 0x3015, Class::kCL },
+			{ 0x3016, 0x3016, Class::kOPW },
+			{ 0x3017, 0x3017, Class::kCL },
+			{ 0x3018, 0x3018, Class::kOPW },
+			{ 0x3019, 0x3019, Class::kCL },
+			{ 0x301A, 0x301A, Class::kOPW },
+			{ 0x301B, 0x301B, Class::kCL },
+			{ 0x301C, 0x301C, Class::kNS },
+			{ 0x301D, 0x301D, Class::kOPW },
+			{ 0x301E, 0x301F, Class::kCL },
+			{ 0x3020, 0x3029, Class::kID },
+			{ 0x302A, 0x302F, Class::kCM },
+			{ 0x3030, 0x303A, Class::kID },
+			{ 0x303B, 0x303C, Class::kNS },
+			{ 0x303D, 0x3040, Class::kID },
+			{ 0x3041, 0x3041, Class::kCJ },
+			{ 0x3042, 0x3042, Class::kID },
+			{ 0x3043, 0x3043, Class::kCJ },
+			{ 0x3044, 0x3044, Class::kID },
+			{ 0x3045, 0x3045, Class::kCJ },
+			{ 0x3046, 0x3046, Class::kID },
+			{ 0x3047, 0x3047, Class::kCJ },
+			{ 0x3048, 0x3048, Class::kID },
+			{ 0x3049, 0x3049, Class::kCJ },
+			{ 0x304A, 0x3062, Class::kID },
+			{ 0x3063, 0x3063, Class::kCJ },
+			{ 0x3064, 0x3082, Class::kID },
+			{ 0x3083, 0x3083, Class::kCJ },
+			{ 0x3084, 0x3084, Class::kID },
+			{ 0x3085, 0x3085, Class::kCJ },
+			{ 0x3086, 0x3086, Class::kID },
+			{ 0x3087, 0x3087, Class::kCJ },
+			{ 0x3088, 0x308D, Class::kID },
+			{ 0x308E, 0x308E, Class::kCJ },
+			{ 0x308F, 0x3094, Class::kID },
+			{ 0x3095, 0x3096, Class::kCJ },
+			{ 0x3097, 0x3098, Class::kID },
+			{ 0x3099, 0x309A, Class::kCM },
+			{ 0x309B, 0x309E, Class::kNS },
+			{ 0x309F, 0x309F, Class::kID },
+			{ 0x30A0, 0x30A0, Class::kNS },
+			{ 0x30A1, 0x30A1, Class::kCJ },
+			{ 0x30A2, 0x30A2, Class::kID },
+			{ 0x30A3, 0x30A3, Class::kCJ },
+			{ 0x30A4, 0x30A4, Class::kID },
+			{ 0x30A5, 0x30A5, Class::kCJ },
+			{ 0x30A6, 0x30A6, Class::kID },
+			{ 0x30A7, 0x30A7, Class::kCJ },
+			{ 0x30A8, 0x30A8, Class::kID },
+			{ 0x30A9, 0x30A9, Class::kCJ },
+			{ 0x30AA, 0x30C2, Class::kID },
+			{ 0x30C3, 0x30C3, Class::kCJ },
+			{ 0x30C4, 0x30E2, Class::kID },
+			{ 0x30E3, 0x30E3, Class::kCJ },
+			{ 0x30E4, 0x30E4, Class::kID },
+			{ 0x30E5, 0x30E5, Class::kCJ },
+			{ 0x30E6, 0x30E6, Class::kID },
+			{ 0x30E7, 0x30E7, Class::kCJ },
+			{ 0x30E8, 0x30ED, Class::kID },
+			{ 0x30EE, 0x30EE, Class::kCJ },
+			{ 0x30EF, 0x30F4, Class::kID },
+			{ 0x30F5, 0x30F6, Class::kCJ },
+			{ 0x30F7, 0x30FA, Class::kID },
+			{ 0x30FB, 0x30FB, Class::kNS },
+			{ 0x30FC, 0x30FC, Class::kCJ },
+			{ 0x30FD, 0x30FE, Class::kNS },
+			{ 0x30FF, 0x31EF, Class::kID },
+			{ 0x31F0, 0x31FF, Class::kCJ },
+			{ 0x3200, 0x4DBF, Class::kID },
+			{ 0x4E00, 0xA4CF, Class::kID },
+			{ 0xA960, 0xA97F, Class::kID },
+			{ 0xAC00, 0xD7A3, Class::kID },
+			{ 0xF900, 0xFAFF, Class::kID },
+			{ 0xFE00, 0xFE0F, Class::kCM },
+			{ 0xFE20, 0xFE2F, Class::kCM },
+			{ 0xFE30, 0xFE4F, Class::kID },
+			{ 0xFEFF, 0xFEFF, Class::kWJ },
+			{ 0xFF01, 0xFF01, Class::kEX },
+			{ 0xFF02, 0xFF07, Class::kID },
+			{ 0xFF08, 0xFF08, Class::kOPW },
+			{ 0xFF09, 0xFF09, Class::kCL },
+			{ 0xFF0A, 0xFF0B, Class::kID },
+			{ 0xFF0C, 0xFF0C, Class::kCL },
+			{ 0xFF0D, 0xFF0D, Class::kID },
+			{ 0xFF0E, 0xFF0E, Class::kCL },
+			{ 0xFF0F, 0xFF19, Class::kID },
+			{ 0xFF1A, 0xFF1B, Class::kNS },
+			{ 0xFF1C, 0xFF1E, Class::kID },
+			{ 0xFF1F, 0xFF1F, Class::kEX },
+			{ 0xFF20, 0xFF3A, Class::kID },
+			{ 0xFF3B, 0xFF3B, Class::kOPW },
+			{ 0xFF3C, 0xFF3C, Class::kID },
+			{ 0xFF3D, 0xFF3D, Class::kCL },
+			{ 0xFF3E, 0xFF5A, Class::kID },
+			{ 0xFF5B, 0xFF5B, Class::kOPW },
+			{ 0xFF5C, 0xFF5C, Class::kID },
+			{ 0xFF5D, 0xFF5D, Class::kCL },
+			{ 0xFF5E, 0xFF5E, Class::kID },
+			{ 0xFF5F, 0xFF5F, Class::kOPW },
+			{ 0xFF60, 0xFF61, Class::kCL },
+			{ 0xFF62, 0xFF62, Class::kOPW },
+			{ 0xFF63, 0xFF64, Class::kCL },
+			{ 0xFF65, 0xFF65, Class::kNS },
+			{ 0xFF66, 0xFF66, Class::kID },
+			{ 0xFF67, 0xFF70, Class::kCJ },
+			{ 0xFF71, 0xFF9D, Class::kID },
+			{ 0xFF9E, 0xFF9F, Class::kNS },
+			{ 0xFFA0, 0xFFDC, Class::kID },
+			{ 0x1F000, 0x1FAFF, Class::kID },
+			{ 0x20000, 0x3FFFD, Class::kID },
+		});
+
+		static_assert(std::ranges::all_of(ranges, [](const Range& a_range) { return a_range.first <= a_range.last; }));
+		static_assert(std::ranges::adjacent_find(ranges, [](const Range& a_lhs, const Range& a_rhs) { return a_lhs.last >= a_rhs.first; }) == ranges.end());
+
+		// stage one maps a block of code points to either a single class or a stage two block,
+		// only blocks mixing several classes get a stage two block
+		constexpr std::size_t   blockSize = 128;
+		constexpr char32_t      tableEnd = 0x40000;
+		constexpr std::size_t   blockCount = tableEnd / blockSize;
+		constexpr std::uint16_t uniformFlag = 0x8000;
+
+		struct BlockInfo
+		{
+			bool  uniform;
+			Class cls;
+		};
+
+		constexpr BlockInfo get_block_info(std::size_t a_block)
+		{
+			const auto lo = static_cast<char32_t>(a_block * blockSize);
+			const auto hi = static_cast<char32_t>(lo + blockSize - 1);
+
+			const auto it = std::ranges::lower_bound(ranges, lo, {}, &Range::last);
+			if (it == ranges.end() || it->first > hi) {
+				return { true, Class::kAL };
+			}
+			if (it->first <= lo && it->last >= hi) {
+				return { true, it->cls };
+			}
+			return { false, Class::kAL };
+		}
+
+		constexpr std::size_t mixedBlockCount = [] {
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < blockCount; ++i) {
+				count += !get_block_info(i).uniform;
+			}
+			return count;
+		}();
+
+		struct Tables
+		{
+			std::array<std::uint16_t, blockCount>                     stage1;
+			std::array<std::array<Class, blockSize>, mixedBlockCount> stage2;
+		};
+
+		constexpr Tables tables = [] {
+			Tables result{};
+
+			std::uint16_t next = 0;
+			for (std::size_t i = 0; i < blockCount; ++i) {
+				const auto info = get_block_info(i);
+				if (info.uniform) {
+					result.stage1[i] = uniformFlag | static_cast<std::uint16_t>(info.cls);
+					continue;
+				}
+
+				const auto lo = static_cast<char32_t>(i * blockSize);
+				const auto hi = static_cast<char32_t>(lo + blockSize - 1);
+
+				auto& block = result.stage2[next];
+				block.fill(Class::kAL);
+				for (auto it = std::ranges::lower_bound(ranges, lo, {}, &Range::last); it != ranges.end() && it->first <= hi; ++it) {
+					for (auto cp = std::max(it->first, lo); cp <= std::min(it->last, hi); ++cp) {
+						block[cp - lo] = it->cls;
+					}
+				}
+				result.stage1[i] = next++;
+			}
+
+			return result;
+		}();
+
+		enum class Action : std::uint8_t
+		{
+			kDirect,      // break allowed
+			kIndirect,    // break allowed only across spaces
+			kProhibited,  // no break, not even across spaces
+		};
+
+		constexpr Action get_action(Class a_before, Class a_after)
+		{
+			using enum Class;
+
+			const auto is_any = [](Class a_class, std::initializer_list<Class> a_classes) {
+				return std::ranges::find(a_classes, a_class) != a_classes.end();
+			};
+
+			// CJ is resolved by the caller, left alone it acts as NS (strict)
+			if (a_before == kCJ) {
+				a_before = kNS;
+			}
+			if (a_after == kCJ) {
+				a_after = kNS;
+			}
+
+			// wide brackets only differ in LB30, latin text can break before 「
+			const bool wideOpen = a_after == kOPW;
+			if (a_before == kOPW) {
+				a_before = kOP;
+			}
+			if (a_after == kOPW) {
+				a_after = kOP;
+			}
+
+			if (is_any(a_after, { kCL, kCP, kEX, kIS, kSY, kWJ })) {  // LB11, LB13
+				return Action::kProhibited;
+			}
+			if (a_before == kOP) {  // LB14
+				return Action::kProhibited;
+			}
+			if (a_before == kQU && a_after == kOP) {  // LB15
+				return Action::kProhibited;
+			}
+			if (is_any(a_before, { kCL, kCP }) && a_after == kNS) {  // LB16
+				return Action::kProhibited;
+			}
+			if (a_after == kGL) {  // LB12a
+				return is_any(a_before, { kBA, kHY }) ? Action::kDirect : Action::kIndirect;
+			}
+			if (is_any(a_before, { kWJ, kGL, kQU, kBB }) || is_any(a_after, { kQU, kBA, kHY, kNS, kIN })) {  // LB11, LB12, LB19, LB21, LB22
+				return Action::kIndirect;
+			}
+
+			// LB23-LB30, numbers and words stay together
+			if (is_any(a_before, { kAL, kNU }) && (is_any(a_after, { kAL, kNU, kPR, kPO }) || (a_after == kOP && !wideOpen))) {
+				return Action::kIndirect;
+			}
+			if (a_before == kPR && is_any(a_after, { kAL, kID, kNU, kOP })) {
+				return Action::kIndirect;
+			}
+			if (a_before == kPO && is_any(a_after, { kAL, kNU, kOP })) {
+				return Action::kIndirect;
+			}
+			if (a_before == kID && a_after == kPO) {
+				return Action::kIndirect;
+			}
+			if (is_any(a_before, { kHY, kIS, kSY }) && a_after == kNU) {
+				return Action::kIndirect;
+			}
+			if (a_before == kIS && a_after == kAL) {
+				return Action::kIndirect;
+			}
+			if (a_before == kCP && is_any(a_after, { kAL, kNU })) {
+				return Action::kIndirect;
+			}
+
+			return Action::kDirect;  // LB31
+		}
+
+		constexpr auto actions = [] {
+			constexpr auto size = std::to_underlying(Class::kTotal);
+
+			std::array<std::array<Action, size>, size> result{};
+			for (std::size_t before = 0; before < size; ++before) {
+				for (std::size_t after = 0; after < size; ++after) {
+					result[before][after] = get_action(static_cast<Class>(before), static_cast<Class>(after));
+				}
+			}
+			return result;
+		}();
+	}
+
+	Class GetClass(char32_t a_codePoint)
+	{
+		if (a_codePoint >= tableEnd) {
+			return a_codePoint >= 0xE0001 && a_codePoint <= 0xE01EF ? Class::kCM : Class::kAL;  // tags and variation selectors
+		}
+
+		const auto entry = tables.stage1[a_codePoint / blockSize];
+		if (entry & uniformFlag) {
+			return static_cast<Class>(entry & ~uniformFlag);
+		}
+		return tables.stage2[entry][a_codePoint % blockSize];
+	}
+
+	Break Breaker::Next(Class a_class)
+	{
+		// LB2, LB10: a string or line never breaks at its start and leading marks stand alone.
+		// leading spaces break like spaces after a letter (LB18)
+		const auto start_line = [&](Class a_first) {
+			sawSpace = a_first == Class::kSP;
+			prev = sawSpace || a_first == Class::kCM ? Class::kAL : a_first;
+		};
+
+		if (!std::exchange(started, true)) {
+			start_line(a_class);
+			return Break::kNone;
+		}
+
+		// LB4, LB5
+		if (prev == Class::kBK || prev == Class::kLF || (prev == Class::kCR && a_class != Class::kLF)) {
+			start_line(a_class);
+			return Break::kMandatory;
+		}
+
+		switch (a_class) {
+		case Class::kBK:
+		case Class::kCR:
+		case Class::kLF:
+		case Class::kZW:  // LB6, LB7
+			prev = a_class;
+			sawSpace = false;
+			return Break::kNone;
+		case Class::kSP:  // LB7
+			sawSpace = true;
+			return Break::kNone;
+		case Class::kCM:  // LB9, marks take the class of their base, LB8 comes first for ZW
+			if (!sawSpace && prev != Class::kZW) {
+				return Break::kNone;
+			}
+			a_class = Class::kAL;  // LB10
+			break;
+		default:
+			break;
+		}
+
+		Break result;
+		if (prev == Class::kZW) {  // LB8
+			result = Break::kAllowed;
+		} else {
+			switch (actions[std::to_underlying(prev)][std::to_underlying(a_class)]) {
+			case Action::kDirect:
+				result = Break::kAllowed;
+				break;
+			case Action::kIndirect:
+				result = sawSpace ? Break::kAllowed : Break::kNone;
+				break;
+			default:
+				result = Break::kNone;
+				break;
+			}
+		}
+
+		prev = a_class;
+		sawSpace = false;
+		return result;
+	}
+}
@@ -1,61 +1,41 @@
 #include "Localization.h"
 
+#include "LocalizationCache.h"
 #include "RE.h"
+#include "SettingLoader.h"
 
-std::string to_string(Language lang)
-{
-	switch (lang) {
-	case Language::kChinese:
-		return "CN";
-	case Language::kGerman:
-		return "DE";
-	case Language::kSpanish:
-		return "ES";
-	case Language::kLatinAmericanSpanish:
-		return "ESMX";
-	case Language::kFrench:
-		return "FR";
-	case Language::kItalian:
-		return "IT";
-	case Language::kJapanese:
-		return "JA";
-	case Language::kPolish:
-		return "PL";
-	case Language::kPortuguese:
-		return "PTBR";
-	case Language::kRussian:
-		return "RUS";
-	default:
-		return "EN";
-	}
-}
-
-Language to_language(std::string_view string)
-{
-	switch (string::const_hash(string)) {
-	case "CN"_h:
-		return Language::kChinese;
-	case "DE"_h:
-		return Language::kGerman;
-	case "ES"_h:
-		return Language::kSpanish;
-	case "ESMX"_h:
-		return Language::kLatinAmericanSpanish;
-	case "FR"_h:
-		return Language::kFrench;
-	case "IT"_h:
-		return Language::kItalian;
-	case "JA"_h:
-		return Language::kJapanese;
-	case "PL"_h:
-		return Language::kPolish;
-	case "PTBR"_h:
-		return Language::kPortuguese;
-	case "RUS"_h:
-		return Language::kRussian;
-	default:
-		return Language::kEnglish;
-	}
+namespace
+{
+	// loose files or archives, whatever the game's resource manager finds first
+	class ResourceStream : public LazySubtitleTable::Stream
+	{
+	public:
+		explicit ResourceStream(const std::string& a_path) :
+			stream(a_path.c_str())
+		{}
+
+		bool IsGood() { return stream.good(); }
+
+		std::uint64_t GetSize() const override { return stream.stream->totalSize; }
+
+		void Seek(std::uint64_t a_position) override
+		{
+			// the game's streams only seek relative to where the last read ended
+			stream.seek(static_cast<std::int32_t>(static_cast<std::int64_t>(a_position) - static_cast<std::int64_t>(position)));
+			position = a_position;
+		}
+
+		void Read(void* a_buffer, std::uint32_t a_size) override
+		{
+			stream.read(a_buffer, a_size);
+			position += a_size;
+		}
+
+	private:
+		// members
+		RE::BSResourceNiBinaryStream stream;
+		std::uint64_t                position{ 0 };
+	};
 }
 
 bool LocalizedSubtitles::LoadGlobalSettings()
@@ -63,6 +43,11 @@ bool LocalizedSubtitles::LoadGlobalSettings()
 	bool rebuildSubs = false;
 	rebuildSubs |= primaryLanguage.LoadSettings(gameLanguage);
 	rebuildSubs |= secondaryLanguage.LoadSettings(gameLanguage);
+
+	if (!loadAllLanguages) {
+		LoadLanguagesAsync(GetConfiguredLanguages());
+	}
+
 	return rebuildSubs;
 }
 
@@ -76,8 +61,210 @@ void LocalizedSubtitles::PostSettingsLoad()
 	}
 }
 
-void LocalizedSubtitles::ReadILStringFiles(MultiSubtitleToIDMap& a_multiSubToID, MultiIDToSubtitleMap& a_multiIDToSub) const
+bool LocalizedSubtitles::ConsumeLoadedLanguages()
+{
+	return languagesLoaded.exchange(false);
+}
+
+std::uint32_t LocalizedSubtitles::GetModIndex(const RE::TESFile* a_file)
+{
+	// light plugins all share compile index 0xFE
+	if (a_file->compileIndex == 0xFE) {
+		return 0xFE000 | a_file->smallFileCompileIndex;
+	}
+	return a_file->compileIndex;
+}
+
+std::uint64_t LocalizedSubtitles::GetPluginKey(const RE::TESTopicInfo* a_topicInfo)
+{
+	constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+
+	const auto get_mod_index = [&](const RE::TESFile* a_file) {
+		return a_file ? GetModIndex(a_file) : none;
+	};
+
+	if (!a_topicInfo) {
+		return (static_cast<std::uint64_t>(none) << 32) | none;
+	}
+	return (static_cast<std::uint64_t>(get_mod_index(a_topicInfo->GetFile(-1))) << 32) | get_mod_index(a_topicInfo->GetFile(0));
+}
+
+LocalizedSubtitles::Row LocalizedSubtitles::FindRow(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo) const
+{
+	const auto& subtitleTable = tables.subtitleTable;
+
+	const auto row = subtitleTable.FindRow(a_localSubtitle);
+	if (row == SubtitleTable::invalidRow || !a_topicInfo) {
+		return row;
+	}
+
+	// the same line can exist in several plugins, prefer the string table of the plugin that owns the topic
+	const auto altIt = tables.alternateRows.find(row);
+	if (altIt == tables.alternateRows.end()) {
+		return row;
+	}
+
+	const auto find_row_for_file = [&](const RE::TESFile* a_file) -> std::optional<Row> {
+		if (!a_file) {
+			return std::nullopt;
+		}
+		const auto modIndex = GetModIndex(a_file);
+		if (GetModIndex(subtitleTable.GetID(row)) == modIndex) {
+			return row;
+		}
+		if (const auto it = std::ranges::find(altIt->second, modIndex, [&](Row a_row) { return GetModIndex(subtitleTable.GetID(a_row)); }); it != altIt->second.end()) {
+			return *it;
+		}
+		return std::nullopt;
+	};
+
+	return find_row_for_file(a_topicInfo->GetFile(-1)).or_else([&] { return find_row_for_file(a_topicInfo->GetFile(0)); }).value_or(row);
+}
+
+void LocalizedSubtitles::LogMemoryUsage() const
+{
+	ReadLocker locker(dataLock);
+
+	if (lazyLoadStrings) {
+		logger::info("Localization tables use {:.2f} MB (lazy)", lazyTable.GetMemoryUsage() / (1024.0 * 1024.0));
+		return;
+	}
+
+	const auto& alternateRows = tables.alternateRows;
+
+	std::size_t alternateSize = alternateRows.bucket_count() * (sizeof(LocalizedTables::AlternateRowMap::value_type) + 1);
+	for (const auto& [row, alternates] : alternateRows) {
+		alternateSize += alternates.capacity() * sizeof(Row);
+	}
+
+	const auto tableSize = tables.subtitleTable.GetMemoryUsage();
+	logger::info("Localization tables use {:.2f} MB ({} ids, {:.2f} MB string tables, {:.2f} MB alternate ids)",
+		(tableSize + alternateSize) / (1024.0 * 1024.0), tables.subtitleTable.GetRowCount(), tableSize / (1024.0 * 1024.0), alternateSize / (1024.0 * 1024.0));
+}
+
+std::string LocalizedSubtitles::FindSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, Language a_language) const
+{
+	if (lazyLoadStrings) {
+		// the same plugin preference as FindRow
+		std::array<std::uint32_t, 2> preferredMods{};
+		std::size_t                   preferredCount = 0;
+		if (a_topicInfo) {
+			for (const auto file : { a_topicInfo->GetFile(-1), a_topicInfo->GetFile(0) }) {
+				if (file) {
+					preferredMods[preferredCount++] = GetModIndex(file);
+				}
+			}
+		}
+
+		if (const auto id = lazyTable.FindID(a_localSubtitle, std::span(preferredMods).first(preferredCount))) {
+			return lazyTable.GetString(*id, a_language).value_or(std::string());
+		}
+		return {};
+	}
+
+	if (const auto row = FindRow(a_localSubtitle, a_topicInfo); row != SubtitleTable::invalidRow) {
+		return std::string(tables.subtitleTable.GetString(row, a_language));
+	}
+	return {};
+}
+
+LocalizedSubtitles::LanguageSet LocalizedSubtitles::GetConfiguredLanguages() const
+{
+	LanguageSet languages;
+	languages.set(std::to_underlying(gameLanguage));
+	for (const auto language : { primaryLanguage.language.get(), secondaryLanguage.language.get() }) {
+		if (language != Language::kNative) {
+			languages.set(std::to_underlying(language));
+		}
+	}
+	return languages;
+}
+
+void LocalizedSubtitles::LoadLanguagesAsync(LanguageSet a_languages)
+{
+	const auto missingLanguages = a_languages & ~loadingLanguages;
+	if (missingLanguages.none()) {
+		return;
+	}
+
+	loadingLanguages |= missingLanguages;
+
+	{
+		std::scoped_lock locker(loaderLock);
+		pendingLanguages |= missingLanguages;
+	}
+	loaderCondition.notify_one();
+
+	if (!languageLoader.joinable()) {
+		languageLoader = std::jthread([this](std::stop_token a_token) { RunLanguageLoader(a_token); });
+	}
+}
+
+void LocalizedSubtitles::RunLanguageLoader(std::stop_token a_token)
 {
+	// one load at a time, languages requested meanwhile are loaded together once it is done
+	while (true) {
+		LanguageSet languages;
+		{
+			std::unique_lock locker(loaderLock);
+			if (!loaderCondition.wait(locker, a_token, [this] { return pendingLanguages.any(); })) {
+				return;
+			}
+			languages = std::exchange(pendingLanguages, {});
+		}
+		LoadLanguages(languages, GetStringFiles(languages));
+	}
+}
+
+void LocalizedSubtitles::LoadLanguages(LanguageSet a_languages, const std::vector<StringFile>& a_files)
+{
+	Timer timer;
+	timer.start();
+
+	if (lazyLoadStrings) {
+		LoadLazyFiles(a_files);
+
+		WriteLocker locker(dataLock);
+		loadedLanguages |= a_languages;
+	} else {
+		const auto partials = ParseStringFiles(a_files);
+		const auto translations = LocalizedTables::GetTranslations(partials, GetFileLanguages(a_files));
+
+		WriteLocker locker(dataLock);
+		tables.AddTranslations(translations);
+		loadedLanguages |= a_languages;
+	}
+
+	languagesLoaded = true;
+
+	timer.stop();
+
+	logger::info("Loading {} additional language(s) took {}", a_languages.count(), timer.duration());
+	LogMemoryUsage();
+
+	// the cache remembers the languages, the next startup loads them before any save sets the globals
+	if (!lazyLoadStrings) {
+		ReadLocker locker(dataLock);
+		LocalizationCache(LocalizationCache::GetFingerprint(gameLanguage, GetStringFiles(loadedLanguages), stringFileIndex)).Save(*this);
+	}
+}
+
+std::vector<LocalizedSubtitles::StringFile> LocalizedSubtitles::GetStringFiles(LanguageSet a_languages) const
+{
+	std::vector<StringFile> files;
+	std::ranges::copy_if(stringFiles, std::back_inserter(files), [&](const StringFile& a_file) {
+		return a_languages.test(std::to_underlying(a_file.language));
+	});
+	return files;
+}
+
+std::vector<LocalizedSubtitles::StringFile> LocalizedSubtitles::CollectStringFiles() const
+{
+	std::vector<StringFile> files;
+
+	std::uint32_t candidates = 0;
+	std::uint32_t skipped = 0;
+
 	const auto& ilStringMap = RE::GetILStringMap();
 	for (const auto& [fileName, info] : ilStringMap) {
 		auto mod = RE::TESDataHandler::GetSingleton()->LookupModByName(fileName);
@@ -89,104 +276,170 @@ void LocalizedSubtitles::ReadILStringFiles(MultiSubtitleToIDMap& a_multiSubToID,
 		baseName.remove_suffix(4);  // remove ".esm"
 
 		for (auto language : stl::enum_range(Language::kChinese, Language::kTotal)) {
-			std::string                  path = std::format("STRINGS\\{}_{}.ILSTRINGS", baseName, to_string(language));
-			RE::BSResourceNiBinaryStream stream(path.c_str());
-
-			if (!stream.good() || stream.stream->totalSize < 8) {
-				continue;
-			}
-
-			std::vector<std::byte> buffer(stream.stream->totalSize);
-			stream.read(buffer.data(), static_cast<std::uint32_t>(buffer.size()));
-
-			RE::ILStringTable stringTable(buffer);
-
-			for (const auto& [stringID, offset] : stringTable.directory) {
-				std::string str = stringTable.GetStringAtOffset(offset);
-				if (str.empty() || string::is_only_space(str)) {
+			for (auto type : stl::enum_range(StringTableType::kStrings, StringTableType::kTotal)) {
+				if (type != StringTableType::kILStrings && !readAllStringTables) {
 					continue;
 				}
-				auto hashedStringID = hash::szudzik_pair(mod->compileIndex, stringID);
-				if (language == gameLanguage) {
-					a_multiSubToID[str].emplace(hashedStringID);
+				auto path = std::format("STRINGS\\{}_{}.{}", baseName, to_string(language), RE::LocalizedStringTable::GetExtension(type));
+
+				++candidates;
+				if (!stringFileIndex.IsEmpty() && !stringFileIndex.Contains(path)) {
+					++skipped;
+					continue;
 				}
-				a_multiIDToSub[hashedStringID][language].emplace(str);
+				files.emplace_back(std::move(path), GetModIndex(mod), language, type);
 			}
 		}
 	}
+
+	// hash map iteration order is arbitrary, merge in load order
+	std::ranges::sort(files, [](const auto& a_lhs, const auto& a_rhs) {
+		return std::tie(a_lhs.modIndex, a_lhs.language, a_lhs.type, a_lhs.path) < std::tie(a_rhs.modIndex, a_rhs.language, a_rhs.type, a_rhs.path);
+	});
+
+	logger::info("{} of {} candidate string tables found, {} lookups skipped", files.size(), candidates, skipped);
+
+	return files;
 }
 
-void LocalizedSubtitles::MergeDuplicateSubtitles(const MultiSubtitleToIDMap& a_multiSubToID, const MultiIDToSubtitleMap& a_multiIDToSub)
+LocalizedSubtitles::StringTable LocalizedSubtitles::ParseStringFile(const StringFile& a_file)
 {
-	const auto pick_best_id = [&](const FlatSet<SubtitleID>& ids) {
-		SubtitleID best = *ids.begin();
+	RE::BSResourceNiBinaryStream stream(a_file.path.c_str());
+	if (!stream.good() || stream.stream->totalSize < 8) {
+		return {};
+	}
 
-		std::size_t bestCount = std::numeric_limits<std::size_t>::max();
-		std::size_t bestTotalLen = 0;
+	// not kept per pool thread, every pool thread would hold on to the largest table it ever read.
+	// the entries view into it until the tables are built, so no string is copied before its arena
+	std::vector<std::byte> buffer(stream.stream->totalSize);
+	stream.read(buffer.data(), static_cast<std::uint32_t>(buffer.size()));
 
-		for (SubtitleID id : ids) {
-			const auto& langMap = a_multiIDToSub.at(id);
+	auto entries = StringTableParser::Parse(buffer, a_file.type, a_file.modIndex);
+	if (!entries) {
+		logger::warn("{} is malformed, skipping", a_file.path);
+		return {};
+	}
 
-			std::size_t count = 0;
-			std::size_t totalLen = 0;
+	return { std::move(buffer), std::move(*entries) };
+}
 
-			for (const auto& [lang, subs] : langMap) {
-				count += subs.size();
-				for (const auto& s : subs) {
-					totalLen += s.size();
-				}
-			}
+std::vector<LocalizedSubtitles::StringTable> LocalizedSubtitles::ParseStringFiles(const std::vector<StringFile>& a_files)
+{
+	// parse each (plugin, language) table on the worker pool
+	std::vector<StringTable> partials(a_files.size());
+	std::transform(std::execution::par, a_files.begin(), a_files.end(), partials.begin(), ParseStringFile);
+	return partials;
+}
 
-			if (count < bestCount || (count == bestCount && totalLen > bestTotalLen)) {
-				best = id;
-				bestCount = count;
-				bestTotalLen = totalLen;
-			}
-		}
-		return best;
-	};
+void LocalizedSubtitles::LoadLazyFiles(const std::vector<StringFile>& a_files)
+{
+	std::vector<std::optional<LazySubtitleTable::File>> lazyFiles(a_files.size());
+	std::transform(std::execution::par, a_files.begin(), a_files.end(), lazyFiles.begin(), [this](const StringFile& a_file) {
+		return lazyTable.ReadFile(a_file.path, a_file.type, a_file.language == gameLanguage);
+	});
 
-	const auto pick_best_subtitle = [&](SubtitleID bestID) {
-		FlatMap<Language, std::string> singleStrings;
-		for (auto& [lang, set] : a_multiIDToSub.at(bestID)) {
-			if (!set.empty()) {
-				singleStrings[lang] = *set.begin();  // take the first string
-			}
+	WriteLocker locker(dataLock);
+	for (std::size_t i = 0; i < a_files.size(); ++i) {
+		if (lazyFiles[i]) {
+			lazyTable.AddFile(a_files[i].modIndex, a_files[i].language, std::move(*lazyFiles[i]));
 		}
-		return singleStrings;
-	};
+	}
+}
 
-	for (auto& [subtitle, ids] : a_multiSubToID) {
-		if (auto [it, result] = subtitleToID.try_emplace(subtitle, pick_best_id(ids)); result) {
-			idToSubtitle.try_emplace(it->second, pick_best_subtitle(it->second));
-		}
+std::unique_ptr<LazySubtitleTable::Stream> LocalizedSubtitles::OpenResourceStream(const std::string& a_path)
+{
+	auto stream = std::make_unique<ResourceStream>(a_path);
+	return stream->IsGood() ? std::move(stream) : nullptr;
+}
+
+std::vector<Language> LocalizedSubtitles::GetFileLanguages(const std::vector<StringFile>& a_files)
+{
+	std::vector<Language> languages;
+	languages.reserve(a_files.size());
+	for (const auto& file : a_files) {
+		languages.push_back(file.language);
 	}
+	return languages;
 }
 
 void LocalizedSubtitles::BuildLocalizedSubtitles()
 {
 	gameLanguage = to_language("sLanguage:General"_ini.value_or("EN"));
 
+	SettingLoader::GetSingleton()->Load(FileType::kSettings, [this](auto& ini) {
+		loadAllLanguages = ini.GetBoolValue("Localization", "bLoadAllLanguages", loadAllLanguages);
+		lazyLoadStrings = ini.GetBoolValue("Localization", "bLazyLoadStrings", lazyLoadStrings);
+		readAllStringTables = ini.GetBoolValue("Localization", "bReadAllStringTables", readAllStringTables);
+	});
+
+	// languages are read early so only the configured ones are ingested
+	primaryLanguage.LoadSettings(gameLanguage);
+	secondaryLanguage.LoadSettings(gameLanguage);
+
+	// no save is loaded yet and the globals hold their defaults, so the languages of the last session are loaded too
+	loadedLanguages = loadAllLanguages ? LanguageSet().set() : GetConfiguredLanguages();
+	if (!loadAllLanguages && !lazyLoadStrings) {
+		loadedLanguages |= LocalizationCache::GetCachedLanguages();
+	}
+	loadingLanguages = loadedLanguages;
+
 	Timer timer;
 	timer.start();
 
-	MultiSubtitleToIDMap multiSubtitleToID;
-	MultiIDToSubtitleMap multiIDToSubtitle;
+	stringFileIndex.Build();
+	logger::info("Indexed {} string tables in loose files and archives", stringFileIndex.GetSize());
+
+	stringFiles = CollectStringFiles();
+
+	const auto files = GetStringFiles(loadedLanguages);
+
+	if (lazyLoadStrings) {
+		lazyTable.SetIndexLanguage(gameLanguage);
+		LoadLazyFiles(files);
+
+		timer.stop();
+		logger::info("Reading string table directories took {}. {} localized strings found ({} languages)", timer.duration(), lazyTable.GetIndexedCount(), loadedLanguages.count());
+		LogMemoryUsage();
+		return;
+	}
+
+	const LocalizationCache cache(LocalizationCache::GetFingerprint(gameLanguage, files, stringFileIndex));
+
+	if (cache.Load(*this)) {
+		timer.stop();
+		logger::info("Loading localization cache took {}. {} localized strings found ({} languages)", timer.duration(), tables.subtitleTable.GetIndexedCount(), loadedLanguages.count());
+		LogMemoryUsage();
+		return;
+	}
+
+	// the read buffers are freed once their strings are in the arenas
+	tables.Build(ParseStringFiles(files), GetFileLanguages(files), gameLanguage);
 
-	ReadILStringFiles(multiSubtitleToID, multiIDToSubtitle);
-	MergeDuplicateSubtitles(multiSubtitleToID, multiIDToSubtitle);
+	cache.Save(*this);
 
 	timer.stop();
 
-	logger::info("Parsing .ILSTRINGS files took {}. {} localized strings found", timer.duration(), subtitleToID.size());
+	logger::info("Parsing string tables took {}. {} localized strings found ({} languages)", timer.duration(), tables.subtitleTable.GetIndexedCount(), loadedLanguages.count());
+	LogMemoryUsage();
 }
 
-LocalizedSubtitle LocalizedSubtitles::GetPrimarySubtitle(const char* a_localSubtitle) const
+std::string LocalizedSubtitles::ResolveSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, Language a_language) const
 {
-	return GetLocalizedSubtitle(a_localSubtitle, primaryLanguage);
+	if (a_language == gameLanguage) {
+		return a_localSubtitle;
+	}
+
+	if (auto subtitle = FindSubtitle(a_localSubtitle, a_topicInfo, a_language); !subtitle.empty()) {
+		return subtitle;
+	}
+
+	return a_localSubtitle;
 }
 
-LocalizedSubtitle LocalizedSubtitles::GetSecondarySubtitle(const char* a_localSubtitle) const
+LocalizedSubtitle LocalizedSubtitles::GetLocalizedSubtitle(const char* a_localSubtitle, const RE::TESTopicInfo* a_topicInfo, const LayoutLanguage& a_language) const
 {
-	return GetLocalizedSubtitle(a_localSubtitle, secondaryLanguage);
+	ReadLocker locker(dataLock);
+	auto       localizedSub = ResolveSubtitle(a_localSubtitle, a_topicInfo, a_language.language);
+	const bool translated = localizedSub != a_localSubtitle;
+	return { std::move(localizedSub), a_language.maxCharsPerLine, translated ? a_language.language : gameLanguage, translated };
 }
@@ -0,0 +1,168 @@
+#include "LocalizationCache.h"
+
+namespace
+{
+	// FNV-1a over 8 byte words, good enough to detect changed files
+	std::uint64_t hash_bytes(std::span<const std::byte> a_bytes, std::uint64_t a_seed = 0xCBF29CE484222325)
+	{
+		constexpr std::uint64_t prime = 0x100000001B3;
+
+		std::uint64_t hash = a_seed ^ a_bytes.size();
+		std::size_t   i = 0;
+
+		for (; i + sizeof(std::uint64_t) <= a_bytes.size(); i += sizeof(std::uint64_t)) {
+			std::uint64_t word;
+			std::memcpy(&word, a_bytes.data() + i, sizeof(std::uint64_t));
+			hash = (hash ^ word) * prime;
+			hash ^= hash >> 32;
+		}
+		for (; i < a_bytes.size(); ++i) {
+			hash = (hash ^ std::to_integer<std::uint64_t>(a_bytes[i])) * prime;
+		}
+
+		return hash;
+	}
+
+	template <class T>
+	std::uint64_t hash_combine(std::uint64_t a_seed, const T& a_value)
+	{
+		if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			return hash_bytes(std::as_bytes(std::span(std::string_view(a_value))), a_seed);
+		} else {
+			return hash_bytes(std::as_bytes(std::span(&a_value, 1)), a_seed);
+		}
+	}
+}
+
+LocalizationCache::LocalizationCache(std::uint64_t a_fingerprint) :
+	path(GetPath()),
+	fingerprint(a_fingerprint)
+{}
+
+std::filesystem::path LocalizationCache::GetPath()
+{
+	if (auto dir = logger::log_directory()) {
+		return *dir / std::format("{}.cache", Version::PROJECT);
+	}
+	return {};
+}
+
+LocalizationCache::LanguageSet LocalizationCache::GetCachedLanguages()
+{
+	const auto path = GetPath();
+	if (path.empty()) {
+		return {};
+	}
+
+	std::ifstream stream(path, std::ios::binary);
+
+	Header header;
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(Header)) || header.magic != MAGIC || header.version != VERSION) {
+		return {};
+	}
+	return LanguageSet(header.languages);
+}
+
+std::uint64_t LocalizationCache::GetFileFingerprint(const StringFile& a_file, const StringFileIndex& a_index)
+{
+	auto hash = hash_combine(VERSION, a_file.path);
+
+	// sizes, write times and archive records, nothing is read
+	if (const auto stamp = a_index.GetStamp(a_file.path)) {
+		return hash_combine(hash, *stamp);
+	}
+
+	// only when the index couldn't be built
+	RE::BSResourceNiBinaryStream stream(a_file.path.c_str());
+	if (!stream.good()) {
+		return hash;
+	}
+
+	std::vector<std::byte> buffer(stream.stream->totalSize);
+	stream.read(buffer.data(), static_cast<std::uint32_t>(buffer.size()));
+
+	return hash_bytes(buffer, hash_combine(hash, buffer.size()));
+}
+
+std::uint64_t LocalizationCache::GetFingerprint(Language a_gameLanguage, const std::vector<StringFile>& a_files, const StringFileIndex& a_index)
+{
+	std::vector<std::uint64_t> fileHashes(a_files.size());
+	std::transform(std::execution::par, a_files.begin(), a_files.end(), fileHashes.begin(), [&](const StringFile& a_file) {
+		return GetFileFingerprint(a_file, a_index);
+	});
+
+	auto hash = hash_combine(hash_combine(VERSION, a_gameLanguage), a_files.size());
+	for (std::size_t i = 0; i < a_files.size(); ++i) {
+		hash = hash_combine(hash_combine(hash, a_files[i].modIndex), fileHashes[i]);
+	}
+
+	return hash;
+}
+
+bool LocalizationCache::Load(LocalizedSubtitles& a_subtitles) const
+{
+	std::error_code ec;
+	if (path.empty() || !std::filesystem::exists(path, ec)) {
+		return false;
+	}
+
+	mmio::mapped_file_source file;
+	if (!file.open(path)) {
+		return false;
+	}
+
+	const std::span data(reinterpret_cast<const std::byte*>(file.data()), file.size());
+
+	if (data.size() < sizeof(Header)) {
+		return false;
+	}
+
+	Header header;
+	std::memcpy(&header, data.data(), sizeof(Header));
+
+	if (header.magic != MAGIC || header.version != VERSION || header.fingerprint != fingerprint) {
+		logger::info("Localization cache is out of date, rebuilding");
+		return false;
+	}
+
+	if (!a_subtitles.tables.Read(data.subspan(sizeof(Header)))) {
+		logger::warn("Localization cache is corrupt, rebuilding");
+		return false;
+	}
+
+	return true;
+}
+
+void LocalizationCache::Save(const LocalizedSubtitles& a_subtitles) const
+{
+	if (path.empty()) {
+		return;
+	}
+
+	auto tempPath = path;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!stream) {
+			logger::warn("Failed to write localization cache to {}", tempPath.string());
+			return;
+		}
+
+		const Header header{ MAGIC, VERSION, fingerprint, static_cast<std::uint32_t>(a_subtitles.loadedLanguages.to_ulong()) };
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+		a_subtitles.tables.Write(stream);
+
+		if (!stream) {
+			logger::warn("Failed to write localization cache to {}", tempPath.string());
+			return;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec) {
+		logger::warn("Failed to write localization cache to {} ({})", path.string(), ec.message());
+	}
+}
@@ -0,0 +1,90 @@
+#include "LocalizedStringTable.h"
+
+namespace RE
+{
+	LocalizedStringTable::LocalizedStringTable(std::span<const std::byte> a_buffer, Type a_type, bool a_directoryOnly) :
+		type(a_type)
+	{
+		std::uint32_t bufferPosition = 0;
+
+		if (!read_uint32(entryCount, a_buffer, bufferPosition) || !read_uint32(dataSize, a_buffer, bufferPosition)) {
+			entryCount = 0;
+			dataSize = 0;
+			return;
+		}
+
+		const auto directorySize = static_cast<std::size_t>(entryCount) * sizeof(DirectoryEntry);
+		if (directorySize + (a_directoryOnly ? 0 : dataSize) > a_buffer.size() - bufferPosition) {
+			entryCount = 0;
+			dataSize = 0;
+			return;
+		}
+
+		directory = a_buffer.subspan(bufferPosition, directorySize);
+		if (!a_directoryOnly) {
+			data = a_buffer.subspan(bufferPosition + directorySize, dataSize);
+		}
+		valid = true;
+	}
+
+	std::optional<std::uint32_t> LocalizedStringTable::GetDirectoryEnd(std::span<const std::byte> a_header)
+	{
+		std::uint32_t bufferPosition = 0;
+		std::uint32_t count;
+		if (!read_uint32(count, a_header, bufferPosition) || count > (std::numeric_limits<std::uint32_t>::max() - headerSize) / sizeof(DirectoryEntry)) {
+			return std::nullopt;
+		}
+		return headerSize + count * static_cast<std::uint32_t>(sizeof(DirectoryEntry));
+	}
+
+	std::string_view LocalizedStringTable::GetExtension(Type a_type)
+	{
+		switch (a_type) {
+		case Type::kStrings:
+			return "STRINGS"sv;
+		case Type::kDLStrings:
+			return "DLSTRINGS"sv;
+		case Type::kILStrings:
+			return "ILSTRINGS"sv;
+		default:
+			std::unreachable();
+		}
+	}
+
+	LocalizedStringTable::DirectoryEntry LocalizedStringTable::GetEntry(std::uint32_t a_index) const
+	{
+		DirectoryEntry entry{};
+		std::memcpy(&entry, directory.data() + (static_cast<std::size_t>(a_index) * sizeof(DirectoryEntry)), sizeof(DirectoryEntry));
+		return entry;
+	}
+
+	std::string_view LocalizedStringTable::GetStringAtOffset(std::uint32_t a_offset) const
+	{
+		if (!IsLengthPrefixed(type)) {
+			if (a_offset >= data.size()) {
+				return {};
+			}
+			const char* strData = reinterpret_cast<const char*>(data.data() + a_offset);
+			const auto  end = static_cast<const char*>(std::memchr(strData, '\0', data.size() - a_offset));
+			return end ? std::string_view(strData, end) : std::string_view{};
+		}
+
+		std::uint32_t length;
+		if (!read_uint32(length, data, a_offset) || length > data.size() - a_offset) {
+			return {};
+		}
+
+		const char* strData = reinterpret_cast<const char*>(data.data() + a_offset);
+		return std::string_view(strData, length ? length - 1 : 0);
+	}
+
+	bool LocalizedStringTable::read_uint32(std::uint32_t& val, std::span<const std::byte> a_buffer, std::uint32_t& a_bufferPosition)
+	{
+		if (a_bufferPosition > a_buffer.size() || a_buffer.size() - a_bufferPosition < sizeof(std::uint32_t)) {
+			return false;
+		}
+		std::memcpy(&val, a_buffer.data() + a_bufferPosition, sizeof(std::uint32_t));
+		a_bufferPosition += sizeof(std::uint32_t);
+		return true;
+	}
+}
@@ -0,0 +1,273 @@
+#include "LocalizedTables.h"
+
+#include "DuplicateSubtitles.h"
+#include "UTF8.h"
+
+namespace
+{
+	class Reader
+	{
+	public:
+		Reader(std::span<const std::byte> a_buffer) :
+			buffer(a_buffer)
+		{}
+
+		template <class T>
+		bool read(T& a_value)
+		{
+			if (buffer.size() - position < sizeof(T)) {
+				return false;
+			}
+			std::memcpy(&a_value, buffer.data() + position, sizeof(T));
+			position += sizeof(T);
+			return true;
+		}
+
+		template <class T>
+		bool read(std::vector<T>& a_values)
+		{
+			std::uint32_t count;
+			if (!read(count) || (buffer.size() - position) / sizeof(T) < count) {
+				return false;
+			}
+			a_values.resize(count);
+			std::memcpy(a_values.data(), buffer.data() + position, count * sizeof(T));
+			position += count * sizeof(T);
+			return true;
+		}
+
+		bool read(std::string& a_value)
+		{
+			std::string_view view;
+			if (!read(view)) {
+				return false;
+			}
+			a_value.assign(view);
+			return true;
+		}
+
+		bool read(std::string_view& a_value)
+		{
+			std::uint32_t length;
+			if (!read(length) || buffer.size() - position < length) {
+				return false;
+			}
+			a_value = std::string_view(reinterpret_cast<const char*>(buffer.data() + position), length);
+			position += length;
+			return true;
+		}
+
+	private:
+		// members
+		std::span<const std::byte> buffer;
+		std::size_t                position{ 0 };
+	};
+
+	class Writer
+	{
+	public:
+		Writer(std::ostream& a_stream) :
+			stream(a_stream)
+		{}
+
+		template <class T>
+		void write(const T& a_value)
+		{
+			stream.write(reinterpret_cast<const char*>(&a_value), sizeof(T));
+		}
+
+		template <class T>
+		void write(const std::vector<T>& a_values)
+		{
+			write(static_cast<std::uint32_t>(a_values.size()));
+			stream.write(reinterpret_cast<const char*>(a_values.data()), a_values.size() * sizeof(T));
+		}
+
+		void write(std::string_view a_value)
+		{
+			write(static_cast<std::uint32_t>(a_value.size()));
+			stream.write(a_value.data(), a_value.size());
+		}
+
+	private:
+		// members
+		std::ostream& stream;
+	};
+}
+
+void LocalizedTables::Build(std::span<const Table> a_partials, std::span<const Language> a_languages, Language a_gameLanguage)
+{
+	DuplicateSubtitles::SubtitleToIDMap multiSubToID;
+	DuplicateSubtitles::IDToSubtitleMap multiIDToSub;
+
+	// merge serially in load order so the result doesn't depend on scheduling. game language strings are matched
+	// against the game's own text byte for byte, so only translations have to be valid UTF-8
+	for (std::size_t i = 0; i < a_partials.size(); ++i) {
+		const auto language = a_languages[i];
+		for (const auto& [id, subtitle] : a_partials[i].entries) {
+			if (language == a_gameLanguage) {
+				multiSubToID[subtitle].emplace(id);
+			} else if (!UTF8::IsValid(subtitle)) {
+				continue;
+			}
+			multiIDToSub[id][language].emplace(subtitle);
+		}
+	}
+
+	// picks run in parallel, rows are then written serially in map order
+	const DuplicateSubtitles duplicates(std::execution::par, multiSubToID, multiIDToSub);
+
+	const auto set_best_subtitles = [&](Row a_row, std::string_view a_subtitle) {
+		for (auto& [lang, set] : duplicates.GetLanguages(subtitleTable.GetID(a_row))) {
+			if (!set.empty()) {
+				subtitleTable.SetString(a_row, lang, lang == a_gameLanguage ? a_subtitle : DuplicateSubtitles::PickSubtitle(set));
+			}
+		}
+		return a_row;
+	};
+
+	subtitleTable.SetIndexLanguage(a_gameLanguage);
+
+	for (const auto& [entry, bestID] : duplicates.GetPicks()) {
+		const auto& [subtitle, ids] = *entry;
+
+		// an id with several game language strings can be the pick for more than one of them, each text gets its own
+		// row so it is indexed too
+		auto row = subtitleTable.AddRow(bestID);
+		if (const auto indexed = subtitleTable.GetString(row, a_gameLanguage); !indexed.empty() && indexed != subtitle) {
+			row = subtitleTable.AddDuplicateRow(bestID);
+		}
+
+		if (!subtitleTable.IndexRow(set_best_subtitles(row, subtitle))) {
+			continue;
+		}
+
+		// keep the other candidates around so subtitles with a known topic can pick their own plugin's translation
+		if (ids.size() > 1) {
+			auto& alternates = alternateRows[row];
+			for (SubtitleID id : ids) {
+				if (id != bestID) {
+					alternates.push_back(set_best_subtitles(subtitleTable.AddRow(id), subtitle));
+				}
+			}
+		}
+	}
+
+	subtitleTable.ShrinkToFit();
+}
+
+LocalizedTables::TranslationMap LocalizedTables::GetTranslations(std::span<const Table> a_partials, std::span<const Language> a_languages)
+{
+	// collected the way Build does, so an id with several strings in a language gets the same one
+	DuplicateSubtitles::IDToSubtitleMap candidates;
+	for (std::size_t i = 0; i < a_partials.size(); ++i) {
+		const auto language = a_languages[i];
+		for (const auto& [id, subtitle] : a_partials[i].entries) {
+			if (UTF8::IsValid(subtitle)) {
+				candidates[id][language].emplace(subtitle);
+			}
+		}
+	}
+
+	TranslationMap translations;
+	translations.reserve(candidates.size());
+	for (const auto& [id, languages] : candidates) {
+		auto& row = translations[id];
+		for (const auto& [language, subtitles] : languages) {
+			row.emplace(language, DuplicateSubtitles::PickSubtitle(subtitles));
+		}
+	}
+	return translations;
+}
+
+void LocalizedTables::AddTranslations(const TranslationMap& a_translations)
+{
+	for (Row row = 0; row < subtitleTable.GetRowCount(); ++row) {
+		if (const auto it = a_translations.find(subtitleTable.GetID(row)); it != a_translations.end()) {
+			for (const auto& [language, subtitle] : it->second) {
+				subtitleTable.SetString(row, language, subtitle);
+			}
+		}
+	}
+	subtitleTable.ShrinkToFit();
+}
+
+void LocalizedTables::Write(std::ostream& a_stream) const
+{
+	Writer writer(a_stream);
+	writer.write(subtitleTable.indexLanguage);
+	writer.write(static_cast<std::uint32_t>(alternateRows.size()));
+
+	writer.write(subtitleTable.ids);
+	writer.write(std::vector<Row>(subtitleTable.reverseIndex.begin(), subtitleTable.reverseIndex.end()));
+
+	for (const auto& [arena, offsets] : subtitleTable.columns) {
+		writer.write(std::string_view(arena));
+		writer.write(offsets);
+	}
+
+	for (const auto& [row, alternates] : alternateRows) {
+		writer.write(row);
+		writer.write(alternates);
+	}
+}
+
+bool LocalizedTables::Read(std::span<const std::byte> a_buffer)
+{
+	Reader reader(a_buffer);
+
+	Language      indexLanguage;
+	std::uint32_t alternateCount;
+	if (!reader.read(indexLanguage) || !reader.read(alternateCount)) {
+		return false;
+	}
+	if (indexLanguage < Language::kChinese || indexLanguage >= Language::kTotal) {
+		return false;
+	}
+
+	std::vector<SubtitleID> ids;
+	SubtitleTable::Columns  columns;
+	std::vector<Row>        indexedRows;
+
+	if (!reader.read(ids) || !reader.read(indexedRows)) {
+		return false;
+	}
+
+	for (auto& [arena, offsets] : columns) {
+		if (!reader.read(arena) || !reader.read(offsets) || offsets.size() > ids.size()) {
+			return false;
+		}
+		if (!arena.empty() && arena.back() != '\0') {
+			return false;
+		}
+		for (const auto offset : offsets) {
+			if (offset != SubtitleTable::invalidOffset && offset >= arena.size()) {
+				return false;
+			}
+		}
+	}
+
+	if (std::ranges::any_of(indexedRows, [&](Row a_row) { return a_row >= ids.size(); })) {
+		return false;
+	}
+
+	AlternateRowMap alternates;
+	alternates.reserve(alternateCount);
+	for (std::uint32_t i = 0; i < alternateCount; ++i) {
+		Row              row;
+		std::vector<Row> rows;
+		if (!reader.read(row) || !reader.read(rows) || row >= ids.size()) {
+			return false;
+		}
+		if (std::ranges::any_of(rows, [&](Row a_row) { return a_row >= ids.size(); })) {
+			return false;
+		}
+		alternates.emplace(row, std::move(rows));
+	}
+
+	subtitleTable.SetIndexLanguage(indexLanguage);
+	subtitleTable.Assign(std::move(ids), std::move(columns), indexedRows);
+	alternateRows = std::move(alternates);
+
+	return true;
+}
@@ -26,13 +26,20 @@ void Manager::LoadGlobalSettings()
 	rebuildSubs |= settings.LoadGlobalSettings();
 	rebuildSubs |= localizedSubs.LoadGlobalSettings();
 
+	localizedSubs.PostSettingsLoad();
+
+	// published before the generation is bumped, so a layout that read the old settings is always redone
+	UpdateLayoutSettings([&](LayoutSettings& a_settings) {
+		a_settings.primary = localizedSubs.GetPrimaryLanguage();
+		a_settings.secondary = localizedSubs.GetSecondaryLanguage();
+		a_settings.showDualSubs = settings.showDualSubs.get();
+	});
+
 	if (rebuildSubs) {
 		ImGui::GetStyle().FontSizeBase = settings.subtitleSize.get() * ImGui::GetResolutionScale();
 		ClearScaleformSubtitle();
-		RebuildProcessedSubtitles();
+		InvalidateProcessedSubtitles();
 	}
-
-	localizedSubs.PostSettingsLoad();
 }
 
 void Manager::OnDataLoaded()
@@ -42,6 +49,13 @@ void Manager::OnDataLoaded()
 	RE::TESLoadGameEvent::GetEventSource()->RegisterSink(this);
 
 	localizedSubs.BuildLocalizedSubtitles();
+	StartLayoutWorker();
+
+	SettingLoader::GetSingleton()->Load(FileType::kSettings, [this](auto& ini) {
+		processedSubtitles.SetBudget(static_cast<std::size_t>(std::max(ini.GetLongValue("Subtitles", "iCacheBudgetKB", static_cast<long>(processedSubtitles.GetBudget() / 1024)), 0L)) * 1024);
+		raycastScheduler.SetRayBudget(static_cast<std::uint32_t>(std::max(ini.GetLongValue("Visibility", "iRayBudget", static_cast<long>(raycastScheduler.GetRayBudget())), 1L)));
+	});
+	logger::info("Subtitle cache budget: {} KB", processedSubtitles.GetBudget() / 1024);
 
 	LoadGlobalSettings();
 
@@ -67,44 +81,329 @@ bool Manager::ShowDialogueSubtitles() const
 	return "bDialogueSubtitles:Interface"_pref.value();
 }
 
-DualSubtitle Manager::CreateDualSubtitles(const char* subtitle) const
+DualSubtitle Manager::CreateDualSubtitles(const char* subtitle, const RE::TESTopicInfo* a_topicInfo, const LayoutSettings& a_settings) const
 {
-	auto primarySub = localizedSubs.GetPrimarySubtitle(subtitle);
-	if (settings.showDualSubs.get()) {
-		auto secondarySub = localizedSubs.GetSecondarySubtitle(subtitle);
+	const auto advances = a_settings.advances.get();
+
+	auto primarySub = localizedSubs.GetLocalizedSubtitle(subtitle, a_topicInfo, a_settings.primary);
+	if (a_settings.showDualSubs) {
+		auto secondarySub = localizedSubs.GetLocalizedSubtitle(subtitle, a_topicInfo, a_settings.secondary);
 		if (!primarySub.empty() && !secondarySub.empty() && primarySub != secondarySub) {
-			return DualSubtitle(primarySub, secondarySub);
+			return DualSubtitle(primarySub, secondarySub, advances);
 		}
 	}
-	return DualSubtitle(primarySub);
+	return DualSubtitle(primarySub, advances);
 }
 
-void Manager::AddProcessedSubtitle(const char* subtitle)
+template <class F>
+void Manager::UpdateLayoutSettings(F&& a_update)
 {
-	WriteLocker locker(subtitleLock);
-	processedSubtitles.try_emplace(subtitle, CreateDualSubtitles(subtitle));
+	// the main thread and the render thread each own part of it, neither may undo the other's update
+	auto current = layoutSettings.load();
+	while (true) {
+		auto updated = std::make_shared<LayoutSettings>(*current);
+		a_update(*updated);
+		if (layoutSettings.compare_exchange_weak(current, std::move(updated))) {
+			return;
+		}
+	}
 }
 
-const DualSubtitle& Manager::GetProcessedSubtitle(const RE::BSFixedStringCS& a_subtitle)
+void Manager::UpdateGlyphAdvances()
 {
-	{
-		ReadLocker readLock(subtitleLock);
-		if (auto it = processedSubtitles.find(a_subtitle.c_str()); it != processedSubtitles.end()) {
-			return it->second;
+	const auto& io = ImGui::GetIO();
+	const auto& style = ImGui::GetStyle();
+
+	const auto font = io.FontDefault ? io.FontDefault : io.Fonts->Fonts[0];
+	const auto size = style.FontSizeBase * style.FontScaleMain * style.FontScaleDpi;
+
+	const auto source = [font, size](char32_t a_codePoint) { return font->GetFontBaked(size)->GetCharAdvance(static_cast<ImWchar>(a_codePoint)); };
+	const auto publish = [&](std::shared_ptr<const GlyphAdvanceTable>&& a_advances) {
+		glyphAdvances = std::move(a_advances);
+		UpdateLayoutSettings([&](LayoutSettings& a_settings) {
+			a_settings.advances = glyphAdvances;
+		});
+	};
+
+	// font ids are never reused, so a rebuilt atlas always gets a new table
+	if (const std::pair key(font->FontId, size); key != glyphAdvancesKey) {
+		publish(std::make_shared<const GlyphAdvanceTable>(source, size));
+		glyphAdvancesKey = key;
+
+		// subtitles laid out with the old table are redone the next time they are looked up
+		InvalidateProcessedSubtitles();
+	}
+
+	// only glyphs of lines about to be shown are measured, the atlas would bake them for drawing anyway
+	std::vector<char32_t>  codePoints;
+	std::vector<LayoutJob> jobs;
+	glyphRequests.Consume([&](GlyphRequest&& a_request) {
+		codePoints.insert(codePoints.end(), a_request.codePoints.begin(), a_request.codePoints.end());
+		jobs.push_back(std::move(a_request.job));
+	});
+	if (jobs.empty()) {
+		return;
+	}
+
+	publish(std::make_shared<const GlyphAdvanceTable>(*glyphAdvances, codePoints, source));
+	for (auto& job : jobs) {
+		layoutQueue.Push(std::move(job));
+	}
+}
+
+void Manager::StartLayoutWorker()
+{
+	layoutWorker = std::jthread([this](std::stop_token a_token) { RunLayoutWorker(a_token); });
+}
+
+void Manager::RunLayoutWorker(std::stop_token a_token)
+{
+	while (true) {
+		layoutQueue.Wait(a_token);
+		if (a_token.stop_requested()) {
+			return;  // whatever is still queued is dropped with the queue
+		}
+		layoutQueue.Consume([this](LayoutJob&& a_job) {
+			AddProcessedSubtitle(a_job);
+		});
+	}
+}
+
+std::uint32_t Manager::ReservePendingSlot(const char* a_subtitle)
+{
+	for (std::uint32_t i = 0; i < pendingAddresses.size(); ++i) {
+		const char* expected = nullptr;
+		if (pendingAddresses[i].compare_exchange_strong(expected, a_subtitle)) {
+			++pendingCount;
+			return i;
 		}
 	}
+	return noPendingSlot;  // more lines waiting than slots, see QueueProcessedSubtitle
+}
+
+void Manager::ReleasePendingSlot(std::uint32_t a_slot)
+{
+	if (a_slot != noPendingSlot) {
+		pendingAddresses[a_slot].store(nullptr);
+		--pendingCount;
+	}
+}
+
+bool Manager::IsPending(const char* a_subtitle) const
+{
+	if (pendingCount.load() == 0) {
+		return false;
+	}
+	return std::ranges::any_of(pendingAddresses, [&](const auto& a_address) { return a_address.load() == a_subtitle; });
+}
+
+void Manager::QueueProcessedSubtitle(const char* a_subtitle, const RE::TESTopicInfo* a_topicInfo)
+{
+	// no locks on the hook. an address already in the index may belong to released text, marking it pending hides it
+	// from readers until the worker has published the new line
+	const auto pendingSlot = ReservePendingSlot(a_subtitle);
+	if (pendingSlot == noPendingSlot) {
+		// every slot is taken, readers can't be told to skip the address. whatever the index holds for it is dropped
+		// instead, the only time the hook takes the lock
+		UnpublishProcessedSubtitle(a_subtitle);
+	}
+	layoutQueue.Push({ a_subtitle, a_subtitle, a_topicInfo, true, pendingSlot });
+}
+
+void Manager::AddProcessedSubtitle(const LayoutJob& a_job)
+{
+	const auto& [text, address, jobTopicInfo, heard, pendingSlot] = a_job;
+
+	const ProcessedSubtitleKey key(text, LocalizedSubtitles::GetPluginKey(jobTopicInfo));
 
+	auto            topicInfo = jobTopicInfo;
+	DualSubtitlePtr previous;  // what a relayout replaces on screen
+	std::uint64_t   generation;
 	{
-		WriteLocker writeLock(subtitleLock);
-		auto [it, inserted] = processedSubtitles.try_emplace(a_subtitle.c_str(), CreateDualSubtitles(a_subtitle.c_str()));
+		Locker locker(subtitleLock);
+		if (const auto processedSub = processedSubtitles.Find(key)) {
+			if (heard && processedSub->generation == layoutGeneration) {
+				++cacheHits;
+				PublishProcessedSubtitle(address, key.second, processedSub->subtitle);
+				ReleasePendingSlot(pendingSlot);
+				return;
+			}
+			topicInfo = processedSub->topicInfo;  // stale layout or new glyphs, redo it with the topic it was first seen with
+			previous = processedSub->subtitle;
+		} else if (!heard) {
+			return;  // evicted since the relayout was queued, it's laid out again when next heard
+		}
+		generation = layoutGeneration;
+	}
+
+	if (heard) {
+		++cacheMisses;
+	}
+
+	while (true) {
+		// laid out without the lock so readers never wait on it. the settings are read after the generation, when they
+		// change meanwhile the generation has moved on too. until the first frame has built a table the lines are left
+		// unwrapped, publishing the table invalidates them
+		const auto layout = layoutSettings.load();
+		auto       dualSubtitle = std::make_shared<const DualSubtitle>(CreateDualSubtitles(text.c_str(), topicInfo, *layout));
+		const auto size = dualSubtitle->GetMemoryUsage() + sizeof(ProcessedSubtitle) + text.size();
+
+		// glyphs the table doesn't have yet were laid out with the fallback width
+		FlatSet<char32_t> missingGlyphs;
+		if (layout->advances) {
+			layout->advances->GetMissing(dualSubtitle->primary.GetText(), missingGlyphs);
+			layout->advances->GetMissing(dualSubtitle->secondary.GetText(), missingGlyphs);
+		}
+
+		Locker locker(subtitleLock);
+		if (generation != layoutGeneration) {
+			generation = layoutGeneration;  // settings changed while laying out
+			continue;
+		}
+		if (!heard && !processedSubtitles.Contains(key)) {
+			return;  // evicted while laid out, inserting it again would overshoot the budget
+		}
+
+		const auto& processedSub = processedSubtitles.Insert(key, { topicInfo, std::move(dualSubtitle), generation }, size);
+
+		// a relayout only replaces the line still shown at its address, the address may have been pruned or handed to
+		// other text since it was queued
+		const auto& index = processedSubtitleIndex.Get();
+		if (const auto it = index.find(std::pair(address, key.second)); heard || (it != index.end() && it->second == previous)) {
+			PublishProcessedSubtitle(address, key.second, processedSub.subtitle);
+		} else {
+			processedSubtitles.Evict([&](const ProcessedSubtitle& a_processedSub) { return IsLive(index, a_processedSub); });
+		}
+		ReleasePendingSlot(pendingSlot);
+
+		// drawn as it is meanwhile
+		if (!missingGlyphs.empty()) {
+			glyphRequests.Push({ std::vector<char32_t>(missingGlyphs.begin(), missingGlyphs.end()), { text, address, topicInfo, false } });
+		}
+		return;
+	}
+}
+
+void Manager::PublishProcessedSubtitle(const char* a_key, std::uint64_t a_pluginKey, const DualSubtitlePtr& a_subtitle)
+{
+	// the pool may hand out a released address to new text, so always overwrite
+	auto index = std::make_unique<ProcessedSubtitleIndex>(processedSubtitleIndex.Get());
+	index->insert_or_assign(std::pair(a_key, a_pluginKey), a_subtitle);
+
+	processedSubtitles.Evict([&](const ProcessedSubtitle& a_processedSub) { return IsLive(*index, a_processedSub); });
+	processedSubtitleIndex.Publish(std::move(index));
+}
+
+void Manager::UnpublishProcessedSubtitle(const char* a_key)
+{
+	const auto has_key = [&](const auto& a_entry) { return a_entry.first.first == a_key; };
+
+	if (std::ranges::none_of(*processedSubtitleIndex.Read(), has_key)) {
+		return;
+	}
+
+	Locker locker(subtitleLock);
+
+	auto index = std::make_unique<ProcessedSubtitleIndex>(processedSubtitleIndex.Get());
+	boost::unordered::erase_if(*index, has_key);
+	processedSubtitleIndex.Publish(std::move(index));
+}
+
+Manager::DualSubtitlePtr Manager::GetProcessedSubtitle(const RE::SubtitleInfoEx& a_subInfo)
+{
+	const auto subtitle = a_subInfo.subtitleText.c_str();
+	const auto pluginKey = LocalizedSubtitles::GetPluginKey(a_subInfo.topicInfo);
+
+	// the hook queued a line at this address, whatever the index holds for it may be the text it replaced
+	if (IsPending(subtitle)) {
+		return nullptr;
+	}
+
+	// no locks and nothing queued. every line on screen went through the hook and is published by the worker, until
+	// then the caller draws the game's text. the subtitle is copied out before the snapshot is let go
+	const auto index = processedSubtitleIndex.Read();
+	if (const auto it = index->find(std::pair(subtitle, pluginKey)); it != index->end()) {
 		return it->second;
 	}
+	return nullptr;
+}
+
+void Manager::PruneProcessedSubtitleIndex(const RE::BSTArray<RE::SubtitleInfoEx>& a_subtitleArray)
+{
+	// drop addresses no longer held by a subtitle, their pool entries may have been released and handed to other text.
+	// both are a handful of entries, so the scan runs every update and the index is only copied when something is stale
+	const auto is_stale = [&](const auto& a_entry) {
+		return std::ranges::none_of(a_subtitleArray, [&](const auto& a_subInfo) { return a_subInfo.subtitleText.c_str() == a_entry.first.first; });
+	};
+
+	if (std::ranges::none_of(*processedSubtitleIndex.Read(), is_stale)) {
+		return;
+	}
+
+	Locker locker(subtitleLock);
+
+	auto index = std::make_unique<ProcessedSubtitleIndex>(processedSubtitleIndex.Get());
+	boost::unordered::erase_if(*index, is_stale);
+	processedSubtitleIndex.Publish(std::move(index));
+}
+
+bool Manager::IsLive(const ProcessedSubtitleIndex& a_liveIndex, const ProcessedSubtitle& a_processedSub)
+{
+	// subtitles on screen are never evicted, anything already handed out stays alive through its shared_ptr.
+	// the index holds a handful of entries
+	return std::ranges::any_of(a_liveIndex, [&](const auto& a_entry) { return a_entry.second == a_processedSub.subtitle; });
+}
+
+void Manager::LogCacheStats() const
+{
+	const auto hits = cacheHits.load();
+	const auto misses = cacheMisses.load();
+	const auto lookups = hits + misses;
+
+	logger::info("Subtitle cache: {} entries, {:.2f} KB resident (budget {} KB), {} hits, {} misses ({:.1f}% hit rate), {} evictions",
+		processedSubtitles.GetSize(), processedSubtitles.GetResidentBytes() / 1024.0f, processedSubtitles.GetBudget() / 1024, hits, misses, lookups ? 100.0f * hits / lookups : 0.0f, processedSubtitles.GetEvictions());
+	logger::info("ShowSubtitle hook latency: {}", hookLatency.ToString());
+	const auto checks = visibilityCache.GetHits() + visibilityCache.GetCasts();
+	logger::info("Visibility cache: {} speakers, {} cached, {} cast ({:.1f}% reused), {} rays ({:.2f} per check), {:.1f} raycasts/s",
+		visibilityCache.GetSize(), visibilityCache.GetHits(), visibilityCache.GetCasts(), checks ? 100.0f * visibilityCache.GetHits() / checks : 0.0f,
+		visibilityCache.GetRays(), visibilityCache.GetCasts() ? static_cast<float>(visibilityCache.GetRays()) / visibilityCache.GetCasts() : 0.0f, visibilityCache.GetRaysPerSecond());
+	logger::info("Raycast scheduler: {} checked, {} on first sight, {} deferred, at most {} waiting in one update (budget {} rays)",
+		raycastScheduler.GetChecked(), raycastScheduler.GetFirstChecks(), raycastScheduler.GetDeferred(), raycastScheduler.GetMaxPending(), raycastScheduler.GetRayBudget());
+}
+
+void Manager::LatencyHistogram::Record(std::chrono::steady_clock::duration a_duration)
+{
+	const auto micro = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count());
+	const auto bucket = std::min<std::size_t>(std::bit_width(micro), buckets.size() - 1);
+	buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string Manager::LatencyHistogram::ToString() const
+{
+	std::string result;
+	for (std::size_t i = 0; i < buckets.size(); ++i) {
+		const auto count = buckets[i].load(std::memory_order_relaxed);
+		if (count == 0) {
+			continue;
+		}
+		if (!result.empty()) {
+			result.append(", ");
+		}
+		if (i + 1 < buckets.size()) {
+			result.append(std::format("<{}us: {}", 1ull << i, count));
+		} else {
+			result.append(std::format(">={}us: {}", 1ull << (i - 1), count));
+		}
+	}
+	return result.empty() ? "no calls" : result;
 }
 
-void Manager::AddSubtitle(RE::SubtitleManager* a_manager, const char* a_subtitle)
+void Manager::AddSubtitle(RE::SubtitleManager* a_manager, const char* a_subtitle, const RE::TESTopicInfo* a_topicInfo)
 {
+	const auto start = std::chrono::steady_clock::now();
+
 	if (!string::is_empty(a_subtitle) && !string::is_only_space(a_subtitle)) {
-		AddProcessedSubtitle(a_subtitle);
+		QueueProcessedSubtitle(a_subtitle, a_topicInfo);
 
 		RE::BSAutoWriteLock gameLocker(a_manager->GetRWLock());
 		{
@@ -117,14 +416,29 @@ void Manager::AddSubtitle(RE::SubtitleManager* a_manager, const char* a_subtitle
 			}
 		}
 	}
+
+	hookLatency.Record(std::chrono::steady_clock::now() - start);
 }
 
-void Manager::RebuildProcessedSubtitles()
+void Manager::InvalidateProcessedSubtitles()
 {
-	WriteLocker locker(subtitleLock);
-	for (auto& [text, subs] : processedSubtitles) {
-		subs = CreateDualSubtitles(text.c_str());
+	// nothing is laid out here, entries off screen are redone when they're next looked up
+	Locker locker(subtitleLock);
+	++layoutGeneration;
+
+	// subtitles on screen stay published, so they keep being drawn and are never evicted.
+	// they are queued right away and the worker replaces them one by one
+	FlatMap<const DualSubtitle*, const char*> liveSubtitles;
+	for (const auto& [key, subtitle] : processedSubtitleIndex.Get()) {
+		liveSubtitles.emplace(subtitle.get(), key.first);
 	}
+
+	processedSubtitles.ForEach([&](const ProcessedSubtitleKey& a_key, ProcessedSubtitle& a_processedSub) {
+		if (const auto it = liveSubtitles.find(a_processedSub.subtitle.get()); it != liveSubtitles.end() && !a_processedSub.relayoutQueued) {
+			a_processedSub.relayoutQueued = true;
+			layoutQueue.Push({ a_key.first, it->second, a_processedSub.topicInfo, false });
+		}
+	});
 }
 
 void Manager::CalculateAlphaModifier(RE::SubtitleInfoEx& a_subInfo) const
@@ -169,6 +483,11 @@ RE::BSEventNotifyControl Manager::ProcessEvent(const RE::MenuOpenCloseEvent& a_e
 RE::BSEventNotifyControl Manager::ProcessEvent(const RE::TESLoadGameEvent& a_event, RE::BSTEventSource<RE::TESLoadGameEvent>*)
 {
 	LoadGlobalSettings();
+
+	{
+		Locker locker(subtitleLock);
+		LogCacheStats();
+	}
 	
 	return RE::BSEventNotifyControl::kContinue;
 }
@@ -180,7 +499,7 @@ RE::BSEventNotifyControl Manager::ProcessEvent(const RE::PlayerCrosshairModeEven
 	return RE::BSEventNotifyControl::kContinue;
 }
 
-void Manager::CalculateVisibility(RE::SubtitleInfoEx& a_subInfo)
+void Manager::CalculateVisibility(RE::SubtitleInfoEx& a_subInfo, RayPicker& a_picker)
 {
 	const auto ref = a_subInfo.speaker.get();
 	const auto actor = ref->As<RE::Actor>();
@@ -192,7 +511,32 @@ void Manager::CalculateVisibility(RE::SubtitleInfoEx& a_subInfo)
 		return;
 	}
 
-	switch (RayCaster(actor).GetResult(false)) {
+	RayCaster rayCaster(actor);
+	if (rayCaster.IsOffscreen()) {
+		a_subInfo.setFlag(SubtitleFlag::kOffscreen, true);
+		return;
+	}
+
+	const auto now = VisibilityCache::Clock::now();
+	const auto actorPos = actor->GetPosition();
+
+	auto result = visibilityCache.Get(a_subInfo.speaker, rayCaster.GetCameraPos(), actorPos, now);
+	if (!result) {
+		// checked after the loop when it makes the budget, until then the last known result stands. a speaker with no
+		// result yet is checked here, before its alpha is worked out
+		float radius = 0.0f;
+		auto  center = actorPos;
+		if (const auto root = actor->Get3D()) {
+			radius = root->worldBound.fRadius;
+			center = root->worldBound.center;
+		}
+		const auto priority = RaycastScheduler::GetPriority(visibilityCache.GetAge(a_subInfo.speaker, now), rayCaster.GetCameraPos(), center, radius, std::sqrt(maxDistanceEndSq));
+		const auto angularSize = RaycastScheduler::GetAngularSize(rayCaster.GetCameraPos(), center, radius);
+
+		result = raycastScheduler.Schedule(visibilityCache, a_picker, { a_subInfo.speaker, actor, actorPos, priority, angularSize }, rayCaster.GetCameraPos());
+	}
+
+	switch (*result) {
 	case RayCaster::Result::kOffscreen:
 		a_subInfo.setFlag(SubtitleFlag::kOffscreen, true);
 		break;
@@ -206,10 +550,15 @@ void Manager::CalculateVisibility(RE::SubtitleInfoEx& a_subInfo)
 	}
 }
 
-std::string Manager::GetScaleformSubtitle(const RE::BSFixedStringCS& a_subtitle)
+std::string Manager::GetScaleformSubtitle(const RE::SubtitleInfoEx& a_subInfo)
 {
-	auto subtitle = GetProcessedSubtitle(a_subtitle).GetScaleformCompatibleSubtitle(settings.showDualSubs.get());
-	return subtitle.empty() ? a_subtitle.c_str() : subtitle;
+	const auto processedSub = GetProcessedSubtitle(a_subInfo);
+	if (!processedSub) {
+		return a_subInfo.subtitleText.c_str();
+	}
+
+	auto subtitle = processedSub->GetScaleformCompatibleSubtitle(settings.showDualSubs.get());
+	return subtitle.empty() ? a_subInfo.subtitleText.c_str() : subtitle;
 }
 
 void Manager::ClearScaleformSubtitle(RE::BSTValueEventSource<RE::HUDSubtitleDisplayEvent>& a_event, std::string_view a_subtitle)
@@ -231,11 +580,18 @@ void Manager::ClearScaleformSubtitle()
 
 bool Manager::UpdateSubtitleInfo(RE::SubtitleManager* a_manager)
 {
+	if (localizedSubs.ConsumeLoadedLanguages()) {
+		ClearScaleformSubtitle();
+		InvalidateProcessedSubtitles();
+	}
+
 	bool gameSubtitleFound = false;
 
 	RE::BSAutoWriteLock locker(a_manager->GetRWLock());
 	{
 		auto& subtitleArray = reinterpret_cast<RE::BSTArray<RE::SubtitleInfoEx>&>(a_manager->subtitlePriorityArray);
+
+		RayPicker picker;  // every ray of this update is cast from the same camera
 		for (auto& subInfo : subtitleArray) {
 			if (const auto& ref = subInfo.speaker.get()) {
 				if (!subInfo.isFlagSet(SubtitleFlag::kInitialized)) {
@@ -256,7 +612,7 @@ bool Manager::UpdateSubtitleInfo(RE::SubtitleManager* a_manager)
 				if (!ref->IsActor() || ref->IsPlayerRef() && pcCamera->QCameraEquals(RE::CameraState::kFirstPerson) || pcCamera->QCameraEquals(RE::CameraState::kDialogue)) {
 					subInfo.setFlag(SubtitleFlag::kSkip, true);
 				} else {
-					CalculateVisibility(subInfo);
+					CalculateVisibility(subInfo, picker);
 				}
 
 				if (subInfo.isFlagSet(SubtitleFlag::kSkip) || subInfo.isFlagSet(SubtitleFlag::kOffscreen)) {
@@ -270,7 +626,7 @@ bool Manager::UpdateSubtitleInfo(RE::SubtitleManager* a_manager)
 						}
 
 						if (shouldDisplay) {
-							RE::HUDSubtitleDisplayData     data(RE::GetSpeakerName(subInfo), GetScaleformSubtitle(subInfo.subtitleText));
+							RE::HUDSubtitleDisplayData     data(RE::GetSpeakerName(subInfo), GetScaleformSubtitle(subInfo));
 							RE::BSAutoLock<RE::BSSpinLock> l(a_manager->subtitleDisplayData.dataLock);
 							{
 								if (!a_manager->subtitleDisplayData.optionalValue.has_value() || *a_manager->subtitleDisplayData.optionalValue != data) {
@@ -285,10 +641,14 @@ bool Manager::UpdateSubtitleInfo(RE::SubtitleManager* a_manager)
 					}
 				} else {
 					CalculateAlphaModifier(subInfo);
-					ClearScaleformSubtitle(a_manager->subtitleDisplayData, GetScaleformSubtitle(subInfo.subtitleText));
+					ClearScaleformSubtitle(a_manager->subtitleDisplayData, GetScaleformSubtitle(subInfo));
 				}
 			}
 		}
+
+		PruneProcessedSubtitleIndex(subtitleArray);
+		raycastScheduler.Run(visibilityCache, picker, picker.GetCameraPos());
+		visibilityCache.Prune(VisibilityCache::Clock::now());
 	}
 
 	return gameSubtitleFound;
@@ -320,6 +680,8 @@ RE::NiPoint3 Manager::CalculateSubtitleAnchorPos(const RE::SubtitleInfoEx& a_sub
 
 void Manager::Draw()
 {
+	UpdateGlyphAdvances();
+
 	const auto         subtitleManager = RE::SubtitleManager::GetSingleton();
 	RE::BSAutoReadLock locker(subtitleManager->GetRWLock());
 	{
@@ -355,8 +717,12 @@ void Manager::Draw()
 					params.speakerName = RE::GetSpeakerName(subInfo);
 				}
 
-				auto& processedSub = GetProcessedSubtitle(subInfo.subtitleText);
-				processedSub.DrawDualSubtitle(params);
+				// still queued for layout, the game's text is shown on one line until it's ready
+				if (const auto processedSub = GetProcessedSubtitle(subInfo)) {
+					processedSub->DrawDualSubtitle(params);
+				} else {
+					DualSubtitle::DrawUnprocessed(subInfo.subtitleText.c_str(), params);
+				}
 			}
 		}
 	}
@@ -2,39 +2,6 @@
 
 namespace RE
 {
-	ILStringTable::ILStringTable(const std::vector<std::byte>& a_buffer)
-	{
-		std::uint32_t bufferPosition = 0;
-
-		read_uint32(entryCount, a_buffer, bufferPosition);
-		read_uint32(dataSize, a_buffer, bufferPosition);
-
-		directory.reserve(entryCount);
-		for (uint32_t i = 0; i < entryCount; ++i) {
-			DirectoryEntry entry;
-			read_uint32(entry.stringID, a_buffer, bufferPosition);
-			read_uint32(entry.offset, a_buffer, bufferPosition);
-			directory.emplace_back(entry);
-		}
-
-		rawData.assign(a_buffer.data() + bufferPosition, a_buffer.data() + bufferPosition + dataSize);
-	}
-
-	std::string ILStringTable::GetStringAtOffset(std::uint32_t offset) const
-	{
-		std::uint32_t length;
-		read_uint32(length, rawData, offset);
-
-		const char* strData = reinterpret_cast<const char*>(rawData.data() + offset);
-		return std::string(strData, length ? length - 1 : 0);
-	}
-
-	void ILStringTable::read_uint32(std::uint32_t& val, const std::vector<std::byte>& a_buffer, std::uint32_t& a_bufferPosition)
-	{
-		std::memcpy(&val, a_buffer.data() + a_bufferPosition, sizeof(std::uint32_t));
-		a_bufferPosition += sizeof(std::uint32_t);
-	}
-
 	void SubtitleInfoEx::setFlag(Flag a_flag, bool a_set)
 	{
 		if (a_set) {
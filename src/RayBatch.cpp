@@ -0,0 +1,82 @@
+#include "RayBatch.h"
+
+void RayBatch::Add(RE::Actor* a_actor, std::uint32_t a_firstPoint, std::uint32_t a_maxRays)
+{
+	queries.push_back({ a_actor, a_firstPoint, std::clamp(a_maxRays, 1u, pointCount) });
+}
+
+void RayBatch::Clear()
+{
+	queries.clear();
+	rayCount = 0;
+}
+
+void RayBatch::Cast(World& a_world, std::uint32_t a_rayBudget)
+{
+	struct Pending
+	{
+		std::size_t      query;
+		RE::hknpBSWorld* world;
+	};
+
+	std::vector<Pending> pending;
+	pending.reserve(queries.size());
+	for (std::size_t i = 0; i < queries.size(); ++i) {
+		if (const auto world = a_world.GetPhysicsWorld(queries[i].actor)) {
+			pending.emplace_back(i, world);
+		} else {
+			queries[i].result = Result::kOffscreen;
+			queries[i].done = true;
+		}
+	}
+
+	// queries are finished one after another in the order added and only started when all of their rays still fit
+	// the budget, so no cast is cut short and thrown away. those started together are grouped by world
+	std::vector<Pending> group;
+	for (auto first = pending.begin(); first != pending.end();) {
+		// rays a query did not need go to the ones after it
+		auto reserved = rayCount;
+		auto last = first;
+		while (last != pending.end() && (last == pending.begin() || reserved + queries[last->query].maxRays <= a_rayBudget)) {
+			reserved += queries[last->query].maxRays;
+			++last;
+		}
+		if (last == first) {
+			break;
+		}
+
+		group.assign(first, last);
+		std::ranges::stable_sort(group, std::less{}, &Pending::world);
+
+		for (auto begin = group.begin(); begin != group.end();) {
+			const auto world = begin->world;
+			const auto end = std::find_if(begin, group.end(), [&](const Pending& a_pending) { return a_pending.world != world; });
+
+			a_world.BeginPicks(world);
+
+			for (auto it = begin; it != end; ++it) {
+				auto& query = queries[it->query];
+
+				while (!query.done) {
+					const auto point = (query.firstPoint + query.rayCount) % pointCount;
+					const auto visible = a_world.Pick(query.actor, point);
+					++query.rayCount;
+					++rayCount;
+
+					if (visible) {
+						query.result = Result::kVisible;
+						query.nextPoint = point;
+						query.done = true;
+					} else if (query.rayCount == query.maxRays) {
+						query.nextPoint = (query.firstPoint + query.rayCount) % pointCount;
+						query.done = true;
+					}
+				}
+			}
+
+			begin = end;
+		}
+
+		first = last;
+	}
+}
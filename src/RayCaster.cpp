@@ -1,11 +1,28 @@
 #include "RayCaster.h"
 
-#include "ImGui/Util.h"
+namespace
+{
+	constexpr std::array<RE::ACTOR_LOS_LOCATION, RayBatch::pointCount> losLocations{
+		RE::ACTOR_LOS_LOCATION::kEye,
+		RE::ACTOR_LOS_LOCATION::kHead,
+		RE::ACTOR_LOS_LOCATION::kTorso,
+		RE::ACTOR_LOS_LOCATION::kFeet
+	};
+
+	void init_pick_data(RE::bhkPickData& a_pickData, RayCollector& a_collector)
+	{
+		a_pickData.collector = &a_collector;
+		a_pickData.collectorType = static_cast<RE::bhkPickData::COLLECTOR_TYPE>(1);
+		a_pickData.castQuery.filterData.collisionFilterInfo->SetCollisionLayer(RE::COL_LAYER::kLOS);
+		//a_pickData.castQuery.filterData.collisionFilterInfo->SetSystemGroup(RE::PlayerCharacter::GetSingleton()->GetCurrentCollisionGroup());
+	}
+}
 
-RayCollector::RayCollector(RE::Actor* a_actor, RE::hknpBSWorld* a_physicsWorld) :
+RayCollector::RayCollector(RE::Actor* a_actor, RE::hknpBSWorld* a_physicsWorld, BodyOwnerCache* a_bodyOwners) :
 	hknpClosestHitCollector(),
 	actor(a_actor),
-	physicsWorld(a_physicsWorld)
+	physicsWorld(a_physicsWorld),
+	bodyOwners(a_bodyOwners)
 {}
 
 void RayCollector::AddHit(const RE::hknpCollisionResult& a_result)
@@ -22,17 +39,8 @@ void RayCollector::AddHit(const RE::hknpCollisionResult& a_result)
 	case RE::COL_LAYER::kBipedNoCC:
 	case RE::COL_LAYER::kDeadBip:
 	case RE::COL_LAYER::kCharController:
-		{
-			RE::TESObjectREFR* owner = nullptr;
-			if (physicsWorld) {
-				if (auto body = RE::bhkNPCollisionObject::Getbhk(physicsWorld, a_result.hitBodyInfo.bodyId)) {
-					owner = RE::TESObjectREFR::FindReferenceFor3D(body->sceneObject);
-				}
-			}
-
-			if (owner == actor) {
-				hknpClosestHitCollector::AddHit(a_result);
-			}
+		if (GetOwner(a_result.hitBodyInfo.bodyId) == actor) {
+			hknpClosestHitCollector::AddHit(a_result);
 		}
 		break;
 	default:
@@ -40,6 +48,32 @@ void RayCollector::AddHit(const RE::hknpCollisionResult& a_result)
 	}
 }
 
+RE::TESObjectREFR* RayCollector::GetOwner(RE::hknpBodyId a_bodyId) const
+{
+	if (!physicsWorld) {
+		return nullptr;
+	}
+
+	const auto find_owner = [&]() -> RE::TESObjectREFR* {
+		if (auto body = RE::bhkNPCollisionObject::Getbhk(physicsWorld, a_bodyId)) {
+			return RE::TESObjectREFR::FindReferenceFor3D(body->sceneObject);
+		}
+		return nullptr;
+	};
+
+	if (!bodyOwners) {
+		return find_owner();
+	}
+
+	static_assert(sizeof(RE::hknpBodyId) == sizeof(std::uint32_t));
+
+	const auto key = std::make_pair(static_cast<const RE::hknpBSWorld*>(physicsWorld), std::bit_cast<std::uint32_t>(a_bodyId));
+	if (const auto it = bodyOwners->find(key); it != bodyOwners->end()) {
+		return it->second;
+	}
+	return bodyOwners->emplace(key, find_owner()).first->second;
+}
+
 void RayCaster::StartPoint::Init()
 {
 	auto player = RE::PlayerCharacter::GetSingleton();
@@ -65,70 +99,54 @@ RayCaster::RayCaster(RE::Actor* a_target) :
 	startPoint.Init();
 }
 
-RayCaster::Result RayCaster::GetResult(bool a_debugRay)
+bool RayCaster::IsOffscreen() const
 {
 	if (auto root = actor->Get3D()) {
 		if (!RE::Main::WorldRootCamera()->PointInFrustum(root->worldBound.center, root->worldBound.fRadius)) {
-			return Result::kOffscreen;
+			return true;
 		}
 	}
 
-	auto cell = actor->GetParentCell();
+	return GetPhysicsWorld(actor) == nullptr;
+}
+
+RE::hknpBSWorld* RayCaster::GetPhysicsWorld(RE::Actor* a_actor)
+{
+	auto cell = a_actor->GetParentCell();
 	if (!cell || cell->cellState != RE::TESObjectCELL::CELL_STATE::kAttached || !cell->loadedData) {
-		return Result::kOffscreen;
+		return nullptr;
 	}
 
 	auto bhkWorld = cell->GetbhkWorld();
 	if (!bhkWorld || !bhkWorld->worldNP.ptr) {
-		return Result::kOffscreen;
+		return nullptr;
 	}
 
-	targetPoints[0] = actor->CalculateLOSLocation(RE::ACTOR_LOS_LOCATION::kEye);
-	targetPoints[1] = actor->CalculateLOSLocation(RE::ACTOR_LOS_LOCATION::kHead);
-	targetPoints[2] = actor->CalculateLOSLocation(RE::ACTOR_LOS_LOCATION::kTorso);
-	targetPoints[3] = actor->CalculateLOSLocation(RE::ACTOR_LOS_LOCATION::kFeet);
-
-	RE::bhkPickData pickData{};
-
-	RayCollector collector(actor, bhkWorld->worldNP.ptr);
-	pickData.collector = &collector;
-	pickData.collectorType = static_cast<RE::bhkPickData::COLLECTOR_TYPE>(1);
-	pickData.castQuery.filterData.collisionFilterInfo->SetCollisionLayer(RE::COL_LAYER::kLOS);
-	//pickData.castQuery.filterData.collisionFilterInfo->SetSystemGroup(RE::PlayerCharacter::GetSingleton()->GetCurrentCollisionGroup());
-
-	bool result = false;
-
-	for (std::uint32_t i = 0; i < targetPoints.size(); ++i) {
-		if (result) {
-			break;
-		}
-
-		pickData.SetStartEnd(startPoint.camera, targetPoints[i]);
-
-		auto object = RE::TES::GetSingleton()->Pick(pickData);
-		auto owner = object ? RE::TESObjectREFR::FindReferenceFor3D(object) : nullptr;
-		if (owner == actor) {
-			result = true;
-		}
-		if (a_debugRay) {
-			DebugRay(pickData, object, owner, targetPoints[i], debugColors[i]);
-		}
-	}
+	return bhkWorld->worldNP.ptr;
+}
 
-	return result ? Result::kVisible : Result::kObscured;
+RayPicker::RayPicker() :
+	collector(nullptr, nullptr, &bodyOwners)
+{
+	startPoint.Init();
+	init_pick_data(pickData, collector);
 }
 
-void RayCaster::DebugRay(const RE::bhkPickData& a_pickData, RE::NiAVObject* a_obj, [[maybe_unused]] RE::TESObjectREFR* a_owner, const RE::NiPoint3& a_targetPos, ImU32 color) const
+RE::hknpBSWorld* RayPicker::GetPhysicsWorld(RE::Actor* a_actor)
 {
-	const auto hitFrac = a_pickData.GetHitFraction();
-	const auto hitPos = (a_targetPos - startPoint.debug) * hitFrac + startPoint.debug;
+	return RayCaster::GetPhysicsWorld(a_actor);
+}
 
-	ImGui::DrawLine(startPoint.debug, hitPos, a_pickData.HasHit() ? color : IM_COL32_BLACK);
+void RayPicker::BeginPicks(RE::hknpBSWorld* a_world)
+{
+	collector.SetPhysicsWorld(a_world);
+}
 
-	if (a_obj) {
-		auto text = std::format("[{}]",
-			a_pickData.HasHit() ? a_pickData.result.hitBodyInfo.shapeCollisionFilterInfo->GetCollisionLayer() : RE::COL_LAYER::kUnidentified);
+bool RayPicker::Pick(RE::Actor* a_actor, std::uint32_t a_point)
+{
+	collector.SetActor(a_actor);
+	pickData.SetStartEnd(startPoint.camera, a_actor->CalculateLOSLocation(losLocations[a_point]));
 
-		ImGui::DrawTextAtPoint(hitPos, text.c_str(), color);
-	}
+	const auto object = RE::TES::GetSingleton()->Pick(pickData);
+	return object && RE::TESObjectREFR::FindReferenceFor3D(object) == a_actor;
 }
@@ -0,0 +1,79 @@
+#include "RaycastScheduler.h"
+
+namespace
+{
+	float distance(const RE::NiPoint3& a_lhs, const RE::NiPoint3& a_rhs)
+	{
+		const auto offset = a_lhs - a_rhs;
+		return std::sqrt(offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+	}
+}
+
+float RaycastScheduler::GetAngularSize(const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_center, float a_radius)
+{
+	return a_radius / std::max(distance(a_cameraPos, a_center), 1.0f);
+}
+
+float RaycastScheduler::GetPriority(VisibilityCache::Clock::duration a_age, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_center, float a_radius, float a_maxDistance)
+{
+	// age grows without bound so far away speakers still get their turn, the other terms are 0-1
+	const auto age = std::chrono::duration<float>(a_age).count() / std::chrono::duration<float>(VisibilityCache::ttl).count();
+	const auto closeness = 1.0f - std::clamp(distance(a_cameraPos, a_center) / a_maxDistance, 0.0f, 1.0f);
+	const auto size = std::clamp(GetAngularSize(a_cameraPos, a_center, a_radius), 0.0f, 1.0f);
+
+	return age + closeness + size;
+}
+
+RayBatch::Result RaycastScheduler::Schedule(VisibilityCache& a_cache, RayBatch::World& a_world, const Request& a_request, const RE::NiPoint3& a_cameraPos)
+{
+	if (const auto last = a_cache.GetLast(a_request.speaker)) {
+		requests.push_back(a_request);
+		return *last;
+	}
+
+	// alone in the batch, the first query finishes whatever the budget
+	batch.Add(a_request.actor, 0, RayBatch::pointCount);
+	batch.Cast(a_world, 0);
+	a_cache.RecordRays(batch.GetRayCount());
+
+	const auto result = a_cache.Update(a_request.speaker, batch.GetQueries().front(), a_cameraPos, a_request.actorPos, VisibilityCache::Clock::now());
+	batch.Clear();
+	++firstChecks;
+
+	return result;
+}
+
+void RaycastScheduler::Run(VisibilityCache& a_cache, RayBatch::World& a_world, const RE::NiPoint3& a_cameraPos)
+{
+	if (requests.empty()) {
+		return;
+	}
+
+	maxPending = std::max(maxPending, static_cast<std::uint32_t>(requests.size()));
+
+	std::ranges::sort(requests, std::greater{}, &Request::priority);
+
+	for (const auto& request : requests) {
+		// one ray settles a small speaker that was already obscured, the starting point rotates so every point is
+		// tried within four checks. anything else casts until a point is visible, starting where it was last time
+		const bool settled = request.angularSize < smallAngularSize && a_cache.GetLast(request.speaker) == RayBatch::Result::kObscured;
+		batch.Add(request.actor, a_cache.GetNextPoint(request.speaker), settled ? 1 : 4);
+	}
+
+	batch.Cast(a_world, rayBudget);
+	a_cache.RecordRays(batch.GetRayCount());
+
+	const auto now = VisibilityCache::Clock::now();
+	const auto queries = batch.GetQueries();
+	for (std::size_t i = 0; i < requests.size(); ++i) {
+		if (!queries[i].done) {
+			++deferred;
+			continue;
+		}
+		a_cache.Update(requests[i].speaker, queries[i], a_cameraPos, requests[i].actorPos, now);
+		++checked;
+	}
+
+	batch.Clear();
+	requests.clear();
+}
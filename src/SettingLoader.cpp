@@ -26,6 +26,9 @@ void SettingLoader::Load(FileType type, INIFunc a_func, bool a_generate) const
 	case FileType::kFonts:
 		LoadINI(fontsPath, a_func, a_generate);
 		break;
+	case FileType::kSettings:
+		LoadINI(settingsPath, a_func, a_generate);
+		break;
 	default:
 		std::unreachable();
 	}
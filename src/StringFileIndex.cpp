@@ -0,0 +1,181 @@
+#include "StringFileIndex.h"
+
+namespace
+{
+	// https://en.uesp.net/wiki/Fallout4Mod:Archive2
+	struct ArchiveHeader
+	{
+		char          magic[4];  // BTDX
+		std::uint32_t version;
+		char          type[4];  // GNRL or DX10
+		std::uint32_t fileCount;
+		std::uint64_t nameTableOffset;
+	};
+
+	// general archive file record, one per file in name table order
+#pragma pack(push, 4)
+	struct ArchiveFileRecord
+	{
+		std::uint32_t nameHash;
+		char          extension[4];
+		std::uint32_t directoryHash;
+		std::uint32_t flags;
+		std::uint64_t offset;
+		std::uint32_t packedSize;
+		std::uint32_t unpackedSize;
+		std::uint32_t align;  // 0xBAADF00D
+	};
+#pragma pack(pop)
+	static_assert(sizeof(ArchiveFileRecord) == 36);
+
+	bool is_string_table(std::string_view a_path)
+	{
+		return a_path.starts_with("strings\\"sv) && (a_path.ends_with(".strings"sv) || a_path.ends_with(".dlstrings"sv) || a_path.ends_with(".ilstrings"sv));
+	}
+
+	std::uint64_t mix(std::uint64_t a_seed, std::uint64_t a_value)
+	{
+		// splitmix64 finalizer
+		auto x = a_seed ^ (a_value + 0x9E3779B97F4A7C15 + (a_seed << 6) + (a_seed >> 2));
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+		return x ^ (x >> 31);
+	}
+
+	// path::string() converts to the active code page and throws for names it can't represent
+	std::string to_utf8(const std::filesystem::path& a_path)
+	{
+		try {
+			const auto name = a_path.u8string();
+			return { name.begin(), name.end() };
+		} catch (const std::exception&) {
+			return {};
+		}
+	}
+
+	// error_code overloads throughout, one entry that can't be read doesn't end the scan
+	template <class F>
+	void for_each_file(const std::filesystem::path& a_directory, F&& a_func)
+	{
+		std::error_code ec;
+		for (std::filesystem::directory_iterator it(a_directory, ec), end; !ec && it != end; it.increment(ec)) {
+			std::error_code fileEc;
+			if (it->is_regular_file(fileEc)) {
+				a_func(*it);
+			}
+		}
+	}
+
+	std::uint64_t get_file_stamp(const std::filesystem::directory_entry& a_entry)
+	{
+		std::error_code ec;
+		const auto      size = a_entry.file_size(ec);
+		const auto      time = a_entry.last_write_time(ec).time_since_epoch().count();
+		return mix(mix(0, size), static_cast<std::uint64_t>(time));
+	}
+}
+
+void StringFileIndex::Build()
+{
+	tables.clear();
+
+	AddLooseFiles();
+
+	for_each_file("Data", [&](const std::filesystem::directory_entry& a_entry) {
+		if (Normalize(to_utf8(a_entry.path().extension())) == ".ba2"sv) {
+			AddArchive(a_entry);
+		}
+	});
+}
+
+bool StringFileIndex::Contains(std::string_view a_path) const
+{
+	return tables.contains(Normalize(a_path));
+}
+
+std::optional<std::uint64_t> StringFileIndex::GetStamp(std::string_view a_path) const
+{
+	const auto it = tables.find(Normalize(a_path));
+	return it != tables.end() ? std::optional(it->second) : std::nullopt;
+}
+
+std::string StringFileIndex::Normalize(std::string_view a_path)
+{
+	std::string path(a_path);
+	std::ranges::transform(path, path.begin(), [](char a_char) {
+		return a_char == '/' ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(a_char)));
+	});
+	return path;
+}
+
+void StringFileIndex::AddLooseFiles()
+{
+	for_each_file("Data/Strings", [&](const std::filesystem::directory_entry& a_entry) {
+		if (const auto name = to_utf8(a_entry.path().filename()); !name.empty()) {
+			AddTable("strings\\" + name, get_file_stamp(a_entry));
+		}
+	});
+}
+
+void StringFileIndex::AddArchive(const std::filesystem::directory_entry& a_entry)
+{
+	const auto&   path = a_entry.path();
+	const auto    archiveName = to_utf8(path.filename());
+	std::ifstream file(path, std::ios::binary);
+
+	ArchiveHeader header{};
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::string_view(header.magic, 4) != "BTDX"sv) {
+		return;
+	}
+
+	// texture archives never contain string tables
+	if (std::string_view(header.type, 4) != "GNRL"sv) {
+		return;
+	}
+
+	// the counts come from the file, check them against its size before anything is allocated
+	std::error_code ec;
+	const auto      size = a_entry.file_size(ec);
+	if (ec || sizeof(header) + std::uint64_t{ header.fileCount } * sizeof(ArchiveFileRecord) > size || header.nameTableOffset >= size) {
+		logger::warn("{} has a file table past its end", archiveName);
+		return;
+	}
+
+	// the records follow the header, they change whenever a file in the archive is replaced
+	std::vector<ArchiveFileRecord> records(header.fileCount);
+	if (!file.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(ArchiveFileRecord)))) {
+		logger::warn("{} has a truncated file table", archiveName);
+		return;
+	}
+
+	const auto archiveStamp = mix(get_file_stamp(a_entry), std::hash<std::string>{}(Normalize(archiveName)));
+
+	file.seekg(static_cast<std::streamoff>(header.nameTableOffset));
+
+	std::string   name;
+	std::uint64_t position = header.nameTableOffset;
+	for (std::uint32_t i = 0; i < header.fileCount; ++i) {
+		std::uint16_t length;
+		if (position + sizeof(length) > size || !file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+			logger::warn("{} has a truncated name table", archiveName);
+			return;
+		}
+		position += sizeof(length);
+		name.resize(length);
+		if (position + length > size || !file.read(name.data(), length)) {
+			logger::warn("{} has a truncated name table", archiveName);
+			return;
+		}
+		position += length;
+		const auto& record = records[i];
+		AddTable(name, mix(mix(mix(archiveStamp, record.offset), record.packedSize), record.unpackedSize));
+	}
+}
+
+void StringFileIndex::AddTable(std::string_view a_path, std::uint64_t a_stamp)
+{
+	// copies are summed so the stamp doesn't depend on the order archives are listed in
+	if (auto path = Normalize(a_path); is_string_table(path)) {
+		tables[std::move(path)] += a_stamp;
+	}
+}
@@ -0,0 +1,23 @@
+#include "StringTableParser.h"
+
+namespace StringTableParser
+{
+	std::optional<std::vector<Entry>> Parse(std::span<const std::byte> a_buffer, Type a_type, std::uint32_t a_modIndex)
+	{
+		const RE::LocalizedStringTable stringTable(a_buffer, a_type);
+		if (!stringTable.IsValid()) {
+			return std::nullopt;
+		}
+
+		std::vector<Entry> entries;
+		entries.reserve(stringTable.GetEntryCount());
+		stringTable.ForEachString([&](std::uint32_t a_stringID, std::string_view a_str) {
+			if (a_str.empty() || string::is_only_space(a_str)) {
+				return;
+			}
+			entries.emplace_back(GetSubtitleID(a_modIndex, a_stringID), a_str);
+		});
+
+		return entries;
+	}
+}
@@ -0,0 +1,119 @@
+#include "SubtitleTable.h"
+
+SubtitleTable::SubtitleTable() :
+	reverseIndex(0, RowHash{ this }, RowEqual{ this })
+{}
+
+void SubtitleTable::Clear()
+{
+	ids.clear();
+	idToRow.clear();
+	for (auto& [arena, offsets] : columns) {
+		arena.clear();
+		offsets.clear();
+	}
+	reverseIndex.clear();
+}
+
+void SubtitleTable::ShrinkToFit()
+{
+	ids.shrink_to_fit();
+	for (auto& [arena, offsets] : columns) {
+		arena.shrink_to_fit();
+		offsets.shrink_to_fit();
+	}
+}
+
+SubtitleTable::Row SubtitleTable::AddRow(SubtitleID a_id)
+{
+	auto [it, inserted] = idToRow.try_emplace(a_id, static_cast<Row>(ids.size()));
+	if (inserted) {
+		ids.push_back(a_id);
+	}
+	return it->second;
+}
+
+SubtitleTable::Row SubtitleTable::AddDuplicateRow(SubtitleID a_id)
+{
+	ids.push_back(a_id);
+	return static_cast<Row>(ids.size() - 1);
+}
+
+void SubtitleTable::SetString(Row a_row, Language a_language, std::string_view a_string)
+{
+	auto& [arena, offsets] = columns[std::to_underlying(a_language)];
+	if (offsets.size() < ids.size()) {
+		offsets.resize(ids.size(), invalidOffset);
+	}
+
+	if (offsets[a_row] != invalidOffset) {
+		return;
+	}
+
+	if (arena.size() + a_string.size() + 1 >= invalidOffset) {
+		logger::error("Subtitle arena for {} is full, dropping string", to_string(a_language));
+		return;
+	}
+
+	offsets[a_row] = static_cast<std::uint32_t>(arena.size());
+	arena.append(a_string);
+	arena.push_back('\0');
+}
+
+bool SubtitleTable::IndexRow(Row a_row)
+{
+	if (GetString(a_row, indexLanguage).empty()) {
+		return false;
+	}
+	return reverseIndex.insert(a_row).second;
+}
+
+SubtitleTable::Row SubtitleTable::FindRow(SubtitleID a_id) const
+{
+	const auto it = idToRow.find(a_id);
+	return it != idToRow.end() ? it->second : invalidRow;
+}
+
+SubtitleTable::Row SubtitleTable::FindRow(std::string_view a_string) const
+{
+	const auto it = reverseIndex.find(a_string);
+	return it != reverseIndex.end() ? *it : invalidRow;
+}
+
+std::string_view SubtitleTable::GetString(Row a_row, Language a_language) const
+{
+	const auto& [arena, offsets] = columns[std::to_underlying(a_language)];
+	if (a_row >= offsets.size() || offsets[a_row] == invalidOffset) {
+		return {};
+	}
+	return std::string_view(arena.data() + offsets[a_row]);
+}
+
+std::size_t SubtitleTable::GetMemoryUsage() const
+{
+	std::size_t size = ids.capacity() * sizeof(SubtitleID);
+	size += idToRow.bucket_count() * (sizeof(decltype(idToRow)::value_type) + 1);
+	size += reverseIndex.bucket_count() * (sizeof(Row) + 1);
+	for (const auto& [arena, offsets] : columns) {
+		size += arena.capacity() + offsets.capacity() * sizeof(std::uint32_t);
+	}
+	return size;
+}
+
+void SubtitleTable::Assign(std::vector<SubtitleID>&& a_ids, Columns&& a_columns, std::span<const Row> a_indexedRows)
+{
+	Clear();
+
+	ids = std::move(a_ids);
+	columns = std::move(a_columns);
+
+	idToRow.reserve(ids.size());
+	for (Row row = 0; row < ids.size(); ++row) {
+		idToRow.emplace(ids[row], row);
+	}
+
+	reverseIndex.reserve(a_indexedRows.size());
+	for (const auto row : a_indexedRows) {
+		reverseIndex.insert(row);
+	}
+}
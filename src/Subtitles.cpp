@@ -3,150 +3,68 @@
 #include "ImGui/FontStyles.h"
 #include "ImGui/Util.h"
 
-Subtitle::Subtitle(const LocalizedSubtitle& a_subtitle) :
-	lines(WrapText(a_subtitle)),
-	fullLine(a_subtitle.subtitle),
-	validForScaleform(RE::BSScaleformManager::GetSingleton()->IsNameValid(a_subtitle.subtitle.c_str()))
-{}
-
-std::vector<Subtitle::Line> Subtitle::WrapText(const LocalizedSubtitle& a_subtitle)
+namespace
 {
-	std::vector<Line> lines;
-
-	const auto& [text, maxLineWidth, lang] = a_subtitle;
-
-	if (IsTextCJK(text)) {
-		WrapCJKText(lines, text, maxLineWidth);
-	} else {
-		WrapLatinText(lines, text, maxLineWidth);
-	}
-
-	// for drawing lines from bottom to top
-	std::ranges::reverse(lines);
-
-	return lines;
-}
-
-void Subtitle::WrapCJKText(std::vector<Line>& lines, const std::string& text, std::uint32_t maxLineWidth)
-{
-	std::string currentLine;
-	std::size_t i = 0;
-
-	while (i < text.size()) {
-		auto charLen = GetUTF8CharLength(text, i);
-		auto ch = text.substr(i, charLen);
-
-		if (currentLine.size() + ch.size() > maxLineWidth && !currentLine.empty()) {
-			lines.emplace_back(currentLine, ImGui::CalcTextSize(currentLine.c_str()));
-			currentLine = ch;
-		} else {
-			currentLine += ch;
+	void draw_speaker_name(const DualSubtitle::ScreenParams& a_screenParams, float a_posX, float a_posY, float a_lineHeight)
+	{
+		if (a_screenParams.speakerName.empty() || a_screenParams.alphaPrimary < 0.01f) {
+			return;
 		}
 
-		i += charLen;
-	}
+		a_posY -= a_lineHeight;
 
-	if (!currentLine.empty()) {
-		lines.emplace_back(currentLine, ImGui::CalcTextSize(currentLine.c_str()));
-	}
-}
+		auto& style = ImGui::GetStyle();
+		auto  textColor = ImGui::GetColorU32(ImGui::FontStyles::GetSingleton()->GetGameplayHUDColor(), a_screenParams.alphaPrimary);
+		auto  textShadow = ImGui::GetColorU32(style.Colors[ImGuiCol_TextShadow], a_screenParams.alphaPrimary);
+		auto  shadowOffset = style.TextShadowOffset;
 
-void Subtitle::WrapLatinText(std::vector<Line>& lines, const std::string& text, std::uint32_t maxLineWidth)
-{
-	std::istringstream wordStream(text);
-	std::string        word;
-	std::string        currentLine;
-
-	while (wordStream >> word) {
-		std::string line = currentLine.empty() ? word : currentLine + ' ' + word;
-		if (line.size() <= maxLineWidth) {
-			currentLine = line;
-		} else {
-			if (!currentLine.empty()) {
-				lines.emplace_back(currentLine, ImGui::CalcTextSize(currentLine.c_str()));
-			}
-			currentLine = word;
-		}
-	}
+		const ImVec2      textPos(a_posX - (ImGui::CalcTextSize(a_screenParams.speakerName.c_str()).x * 0.5f), a_posY);
+		const std::string line = std::format("{}:", a_screenParams.speakerName);
 
-	if (!currentLine.empty()) {
-		lines.emplace_back(currentLine, ImGui::CalcTextSize(currentLine.c_str()));
+		auto* drawList = ImGui::GetForegroundDrawList();
+		drawList->AddText(textPos + shadowOffset, textShadow, line.c_str());
+		drawList->AddText(textPos, textColor, line.c_str());
 	}
 }
 
-std::uint8_t Subtitle::GetUTF8CharLength(const std::string& str, std::size_t pos)
+Subtitle::Subtitle(const LocalizedSubtitle& a_subtitle, const GlyphAdvanceTable* a_advances) :
+	wrappedText(WrapText(a_subtitle, a_advances))
+{}
+
+bool Subtitle::IsValidForScaleform() const
 {
-	const auto ch = static_cast<unsigned char>(str[pos]);
-	if ((ch & 0x80) == 0) {  // ASCII
-		return 1;
-	}
-	if ((ch & 0xE0) == 0xC0) {  // 2-byte UTF8
-		return 2;
-	}
-	if ((ch & 0xF0) == 0xE0) {  // 3-byte UTF8
-		return 3;
-	}
-	if ((ch & 0xF8) == 0xF0) {  // 4-byte UTF8
-		return 4;
+	// the scaleform manager isn't safe to call from the layout worker
+	if (!validForScaleform) {
+		validForScaleform = RE::BSScaleformManager::GetSingleton()->IsNameValid(GetText().data());
 	}
-	return 1;
+	return *validForScaleform;
 }
 
-bool Subtitle::IsTextCJK(const std::string& str)
+TextLayout::WrappedText Subtitle::WrapText(const LocalizedSubtitle& a_subtitle, const GlyphAdvanceTable* a_advances)
 {
-	constexpr auto IsCJKCodePoint = [](char32_t cp) {
-		return (cp >= 0x4E00 && cp <= 0x9FFF) ||
-		       (cp >= 0x3400 && cp <= 0x4DBF) ||
-		       (cp >= 0x20000 && cp <= 0x2EBEF) ||
-		       (cp >= 0xF900 && cp <= 0xFAFF) ||
-		       (cp >= 0x2F800 && cp <= 0x2FA1F) ||
-		       (cp >= 0x3040 && cp <= 0x309F) ||
-		       (cp >= 0x30A0 && cp <= 0x30FF) ||
-		       (cp >= 0xAC00 && cp <= 0xD7AF);
-	};
-
-	std::size_t i = 0;
-	while (i < str.size()) {
-		auto charLen = GetUTF8CharLength(str, i);
-		if (i + charLen > str.size()) {
-			break;
-		}
+	const auto& [text, maxCharsPerLine, lang, fromStringTable] = a_subtitle;
+	if (!a_advances) {
+		return TextLayout::WrappedText(text, {});
+	}
 
-		char32_t cp = 0;
-		switch (charLen) {
-		case 1:
-			cp = static_cast<unsigned char>(str[i]);
-			break;
-		case 2:
-			cp = ((static_cast<unsigned char>(str[i]) & 0x1F) << 6) |
-			     (static_cast<unsigned char>(str[i + 1]) & 0x3F);
-			break;
-		case 3:
-			cp = ((static_cast<unsigned char>(str[i]) & 0x0F) << 12) |
-			     ((static_cast<unsigned char>(str[i + 1]) & 0x3F) << 6) |
-			     (static_cast<unsigned char>(str[i + 2]) & 0x3F);
-			break;
-		case 4:
-			cp = ((static_cast<unsigned char>(str[i]) & 0x07) << 18) |
-			     ((static_cast<unsigned char>(str[i + 1]) & 0x3F) << 12) |
-			     ((static_cast<unsigned char>(str[i + 2]) & 0x3F) << 6) |
-			     (static_cast<unsigned char>(str[i + 3]) & 0x3F);
-			break;
-		default:
-			break;
-		}
+	const float maxLineWidth = TextLayout::GetMaxWidth(text, maxCharsPerLine, *a_advances);
 
-		if (IsCJKCodePoint(cp)) {
-			return true;
-		}
+	// only the game's own text is scanned, a translation is in the script of its language
+	const auto script = fromStringTable ? TextLayout::GetScript(lang) : TextLayout::GetScript(lang, text);
 
-		i += charLen;
-	}
+	// lines are wrapped into a buffer kept by the thread and copied out next to the text, one allocation per subtitle
+	thread_local std::vector<Line> lines;
+	TextLayout::Wrap(script, text, maxLineWidth, *a_advances, lines);
 
-	return false;
+	return TextLayout::WrappedText(text, lines);
 }
 
 void Subtitle::DrawSubtitle(float a_posX, float& a_posY, float a_alpha, float a_lineHeight) const
+{
+	DrawSubtitle(GetText(), wrappedText.GetLines(), a_posX, a_posY, a_alpha, a_lineHeight);
+}
+
+void Subtitle::DrawSubtitle(std::string_view a_text, std::span<const Line> a_lines, float a_posX, float& a_posY, float a_alpha, float a_lineHeight)
 {
 	if (a_alpha < 0.01f) {
 		return;
@@ -159,21 +77,37 @@ void Subtitle::DrawSubtitle(float a_posX, float& a_posY, float a_alpha, float a_
 	auto        textShadow = ImGui::GetColorU32(style.Colors[ImGuiCol_TextShadow], a_alpha);
 	auto        shadowOffset = style.TextShadowOffset;
 
-	for (const auto& [line, textSize] : lines) {
+	const auto draw_line = [&](std::string_view a_line, float a_width) {
 		a_posY -= a_lineHeight;
-		const ImVec2 textPos(a_posX - (textSize.x * 0.5f), a_posY);
-		drawList->AddText(textPos + shadowOffset, textShadow, line.c_str());
-		drawList->AddText(textPos, textColor, line.c_str());
+		const ImVec2 textPos(a_posX - (a_width * 0.5f), a_posY);
+		drawList->AddText(textPos + shadowOffset, textShadow, a_line.data(), a_line.data() + a_line.size());
+		drawList->AddText(textPos, textColor, a_line.data(), a_line.data() + a_line.size());
+	};
+
+	// not wrapped yet
+	if (a_lines.empty()) {
+		draw_line(a_text, ImGui::CalcTextSize(a_text.data(), a_text.data() + a_text.size()).x);
+		return;
+	}
+
+	// bottom to top
+	for (const auto& [offset, length, width] : a_lines | std::views::reverse) {
+		draw_line(a_text.substr(offset, length), width);
 	}
 }
 
-DualSubtitle::DualSubtitle(const LocalizedSubtitle& a_primarySubtitle) :
-	primary(a_primarySubtitle)
+std::size_t Subtitle::GetMemoryUsage() const
+{
+	return wrappedText.GetMemoryUsage();
+}
+
+DualSubtitle::DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const GlyphAdvanceTable* a_advances) :
+	primary(a_primarySubtitle, a_advances)
 {}
 
-DualSubtitle::DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const LocalizedSubtitle& a_secondarySubtitle) :
-	primary(a_primarySubtitle),
-	secondary(a_secondarySubtitle)
+DualSubtitle::DualSubtitle(const LocalizedSubtitle& a_primarySubtitle, const LocalizedSubtitle& a_secondarySubtitle, const GlyphAdvanceTable* a_advances) :
+	primary(a_primarySubtitle, a_advances),
+	secondary(a_secondarySubtitle, a_advances)
 {}
 
 void DualSubtitle::DrawDualSubtitle(const ScreenParams& a_screenParams) const
@@ -181,41 +115,40 @@ void DualSubtitle::DrawDualSubtitle(const ScreenParams& a_screenParams) const
 	const auto lineHeight = ImGui::GetTextLineHeight();
 	auto [posX, posY] = a_screenParams.pos;
 
-	if (!secondary.lines.empty()) {
+	if (!secondary.empty()) {
 		secondary.DrawSubtitle(posX, posY, a_screenParams.alphaSecondary, lineHeight);
 		posY -= lineHeight * a_screenParams.spacing;
 	}
 
 	primary.DrawSubtitle(posX, posY, a_screenParams.alphaPrimary, lineHeight);
+	draw_speaker_name(a_screenParams, posX, posY, lineHeight);
+}
 
-	if (!a_screenParams.speakerName.empty() && a_screenParams.alphaPrimary >= 0.01f) {
-		posY -= lineHeight;
-
-		auto& style = ImGui::GetStyle();
-		auto  textColor = ImGui::GetColorU32(ImGui::FontStyles::GetSingleton()->GetGameplayHUDColor(), a_screenParams.alphaPrimary);
-		auto  textShadow = ImGui::GetColorU32(style.Colors[ImGuiCol_TextShadow], a_screenParams.alphaPrimary);
-		auto  shadowOffset = style.TextShadowOffset;
-
-		const ImVec2      textPos(posX - (ImGui::CalcTextSize(a_screenParams.speakerName.c_str()).x * 0.5f), posY);
-		const std::string line = std::format("{}:", a_screenParams.speakerName);
+void DualSubtitle::DrawUnprocessed(std::string_view a_text, const ScreenParams& a_screenParams)
+{
+	const auto lineHeight = ImGui::GetTextLineHeight();
+	auto [posX, posY] = a_screenParams.pos;
 
-		auto* drawList = ImGui::GetForegroundDrawList();
-		drawList->AddText(textPos + shadowOffset, textShadow, line.c_str());
-		drawList->AddText(textPos, textColor, line.c_str());
-	}
+	Subtitle::DrawSubtitle(a_text, {}, posX, posY, a_screenParams.alphaPrimary, lineHeight);
+	draw_speaker_name(a_screenParams, posX, posY, lineHeight);
 }
 
 std::string DualSubtitle::GetScaleformCompatibleSubtitle(bool a_dualSubs) const
 {
 	std::string subtitle;
-	if (primary.validForScaleform) {
-		subtitle = primary.fullLine;
+	if (primary.IsValidForScaleform()) {
+		subtitle = primary.GetText();
 	}
-	if (a_dualSubs && secondary.validForScaleform) {
+	if (a_dualSubs && !secondary.empty() && secondary.IsValidForScaleform()) {
 		if (!subtitle.empty()) {
 			subtitle.append("\n");
 		}
-		subtitle.append(secondary.fullLine);
+		subtitle.append(secondary.GetText());
 	}
 	return subtitle;
 }
+
+std::size_t DualSubtitle::GetMemoryUsage() const
+{
+	return sizeof(DualSubtitle) + primary.GetMemoryUsage() + secondary.GetMemoryUsage();
+}
@@ -0,0 +1,401 @@
+#include "TextLayout.h"
+
+#include "LineBreak.h"
+#include "UTF8.h"
+
+namespace
+{
+	struct UniformBlock
+	{
+		char32_t first;
+		char32_t last;
+	};
+
+	// one measurement stands for the whole block
+	constexpr std::array uniformBlocks{
+		UniformBlock{ 0x3400, 0x4DBF },  // cjk ideographs
+		UniformBlock{ 0x4E00, 0x9FFF },
+		UniformBlock{ 0xAC00, 0xD7A3 },  // hangul syllables
+		UniformBlock{ 0xF900, 0xFAFF }   // cjk compatibility ideographs
+	};
+}
+
+GlyphAdvanceTable::GlyphAdvanceTable(const Source& a_source, float a_fontSize) :
+	fontSize(a_fontSize),
+	fallbackAdvance(a_source(0xFFFD))
+{
+	for (char32_t ch = 0x20; ch < 0x7F; ++ch) {
+		ascii[ch] = a_source(ch);
+	}
+	for (char32_t ch = 'a'; ch <= 'z'; ++ch) {
+		averageAdvance += ascii[ch];
+	}
+	averageAdvance /= 26.0f;
+}
+
+GlyphAdvanceTable::GlyphAdvanceTable(const GlyphAdvanceTable& a_base, std::span<const char32_t> a_codePoints, const Source& a_source) :
+	GlyphAdvanceTable(a_base)
+{
+	for (const auto codePoint : a_codePoints) {
+		if (!Contains(codePoint)) {
+			other.emplace(GetKey(codePoint), a_source(codePoint));
+		}
+	}
+}
+
+char32_t GlyphAdvanceTable::GetKey(char32_t a_codePoint)
+{
+	for (const auto& [first, last] : uniformBlocks) {
+		if (a_codePoint >= first && a_codePoint <= last) {
+			return first;
+		}
+	}
+	return a_codePoint;
+}
+
+float GlyphAdvanceTable::GetAdvance(char32_t a_codePoint) const
+{
+	if (a_codePoint < ascii.size()) {
+		return ascii[a_codePoint];
+	}
+	if (const auto it = other.find(GetKey(a_codePoint)); it != other.end()) {
+		return it->second;
+	}
+	return fallbackAdvance;
+}
+
+bool GlyphAdvanceTable::Contains(char32_t a_codePoint) const
+{
+	return a_codePoint < ascii.size() || other.contains(GetKey(a_codePoint));
+}
+
+void GlyphAdvanceTable::GetMissing(std::string_view a_text, FlatSet<char32_t>& a_missing) const
+{
+	for (std::size_t i = 0; i < a_text.size();) {
+		if (static_cast<unsigned char>(a_text[i]) < 0x80) {
+			++i;
+			continue;
+		}
+		if (const auto codePoint = TextLayout::DecodeUTF8(a_text, i); !Contains(codePoint)) {
+			a_missing.insert(codePoint);
+		}
+	}
+}
+
+namespace TextLayout
+{
+	char32_t DecodeUTF8(std::string_view a_text, std::size_t& a_pos)
+	{
+		constexpr char32_t replacement = 0xFFFD;
+
+		const auto lead = static_cast<unsigned char>(a_text[a_pos]);
+
+		std::size_t length;
+		char32_t    cp;
+		if ((lead & 0x80) == 0) {  // ASCII
+			++a_pos;
+			return lead;
+		} else if ((lead & 0xE0) == 0xC0) {  // 2-byte UTF8
+			length = 2;
+			cp = lead & 0x1F;
+		} else if ((lead & 0xF0) == 0xE0) {  // 3-byte UTF8
+			length = 3;
+			cp = lead & 0x0F;
+		} else if ((lead & 0xF8) == 0xF0) {  // 4-byte UTF8
+			length = 4;
+			cp = lead & 0x07;
+		} else {
+			++a_pos;
+			return replacement;
+		}
+
+		if (a_pos + length > a_text.size()) {
+			++a_pos;
+			return replacement;
+		}
+
+		for (std::size_t i = 1; i < length; ++i) {
+			const auto next = static_cast<unsigned char>(a_text[a_pos + i]);
+			if ((next & 0xC0) != 0x80) {
+				++a_pos;
+				return replacement;
+			}
+			cp = (cp << 6) | (next & 0x3F);
+		}
+
+		a_pos += length;
+		return cp;
+	}
+
+	namespace
+	{
+		// decodes the common sequence length of the script inline and defers everything else to DecodeUTF8
+		template <std::size_t Length>
+		char32_t decode_fast(std::string_view a_text, std::size_t& a_pos)
+		{
+			const auto byte = [&](std::size_t a_offset) { return static_cast<unsigned char>(a_text[a_pos + a_offset]); };
+
+			if (const auto lead = byte(0); lead < 0x80) {
+				++a_pos;
+				return lead;
+			} else if constexpr (Length == 2) {
+				if ((lead & 0xE0) == 0xC0 && a_pos + 1 < a_text.size() && (byte(1) & 0xC0) == 0x80) {
+					const auto cp = (static_cast<char32_t>(lead & 0x1F) << 6) | (byte(1) & 0x3F);
+					a_pos += 2;
+					return cp;
+				}
+			} else if constexpr (Length == 3) {
+				if ((lead & 0xF0) == 0xE0 && a_pos + 2 < a_text.size() && (byte(1) & 0xC0) == 0x80 && (byte(2) & 0xC0) == 0x80) {
+					const auto cp = (static_cast<char32_t>(lead & 0x0F) << 12) | (static_cast<char32_t>(byte(1) & 0x3F) << 6) | (byte(2) & 0x3F);
+					a_pos += 3;
+					return cp;
+				}
+			}
+
+			return DecodeUTF8(a_text, a_pos);
+		}
+
+		// text that passed UTF8::IsValid, the lead byte alone gives the length
+		char32_t decode_valid(std::string_view a_text, std::size_t& a_pos)
+		{
+			const auto byte = [&](std::size_t a_offset) { return static_cast<char32_t>(static_cast<unsigned char>(a_text[a_pos + a_offset])); };
+
+			const auto lead = byte(0);
+			char32_t   cp;
+			if (lead < 0x80) {
+				cp = lead;
+				a_pos += 1;
+			} else if (lead < 0xE0) {
+				cp = ((lead & 0x1F) << 6) | (byte(1) & 0x3F);
+				a_pos += 2;
+			} else if (lead < 0xF0) {
+				cp = ((lead & 0x0F) << 12) | ((byte(1) & 0x3F) << 6) | (byte(2) & 0x3F);
+				a_pos += 3;
+			} else {
+				cp = ((lead & 0x07) << 18) | ((byte(1) & 0x3F) << 12) | ((byte(2) & 0x3F) << 6) | (byte(3) & 0x3F);
+				a_pos += 4;
+			}
+			return cp;
+		}
+
+		template <Script S>
+		struct ScriptPolicy;
+
+		template <>
+		struct ScriptPolicy<Script::kLatin>
+		{
+			static char32_t         Decode(std::string_view a_text, std::size_t& a_pos) { return decode_fast<1>(a_text, a_pos); }
+			static LineBreak::Class Resolve(LineBreak::Class a_class) { return a_class; }
+		};
+
+		template <>
+		struct ScriptPolicy<Script::kCyrillic>
+		{
+			static char32_t         Decode(std::string_view a_text, std::size_t& a_pos) { return decode_fast<2>(a_text, a_pos); }
+			static LineBreak::Class Resolve(LineBreak::Class a_class) { return a_class; }
+		};
+
+		// Chinese text may start a line with small kana, CJ is ID
+		template <>
+		struct ScriptPolicy<Script::kCJK>
+		{
+			static char32_t         Decode(std::string_view a_text, std::size_t& a_pos) { return decode_fast<3>(a_text, a_pos); }
+			static LineBreak::Class Resolve(LineBreak::Class a_class) { return a_class == LineBreak::Class::kCJ ? LineBreak::Class::kID : a_class; }
+		};
+
+		// strict kinsoku, small kana and the prolonged sound mark never start a line
+		template <>
+		struct ScriptPolicy<Script::kJapanese>
+		{
+			static char32_t         Decode(std::string_view a_text, std::size_t& a_pos) { return decode_fast<3>(a_text, a_pos); }
+			static LineBreak::Class Resolve(LineBreak::Class a_class) { return a_class == LineBreak::Class::kCJ ? LineBreak::Class::kNS : a_class; }
+		};
+	}
+
+	template <Script S, bool Valid>
+	void Wrap(std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances, std::vector<Line>& a_lines)
+	{
+		using Policy = ScriptPolicy<S>;
+
+		a_lines.clear();
+		LineBreak::Breaker breaker;
+
+		Line  currentLine{};
+		bool  lineOpen = false;
+		float gapWidth = 0.0f;  // trailing whitespace of the last segment on the line
+
+		// segment between two break opportunities, its content ends at the last non-space
+		std::size_t segmentStart = 0;
+		std::size_t contentEnd = 0;
+		float       contentWidth = 0.0f;
+		float       segmentWidth = 0.0f;
+
+		const auto close_segment = [&](std::size_t a_next) {
+			if (contentEnd > segmentStart) {
+				const auto length = static_cast<std::uint32_t>(contentEnd - segmentStart);
+				if (!lineOpen) {
+					currentLine = { static_cast<std::uint32_t>(segmentStart), length, contentWidth };
+					lineOpen = true;
+				} else if (currentLine.width + gapWidth + contentWidth <= a_maxWidth) {
+					currentLine.length = static_cast<std::uint32_t>(contentEnd - currentLine.offset);
+					currentLine.width += gapWidth + contentWidth;
+				} else {
+					a_lines.push_back(std::exchange(currentLine, { static_cast<std::uint32_t>(segmentStart), length, contentWidth }));
+				}
+				gapWidth = segmentWidth - contentWidth;
+			} else if (lineOpen) {
+				gapWidth += segmentWidth;
+			}
+
+			segmentStart = contentEnd = a_next;
+			contentWidth = segmentWidth = 0.0f;
+		};
+
+		const auto close_line = [&] {
+			if (std::exchange(lineOpen, false)) {
+				a_lines.push_back(currentLine);
+			}
+			gapWidth = 0.0f;
+		};
+
+		std::size_t i = 0;
+		while (i < a_text.size()) {
+			const auto start = i;
+			const auto cp = Valid ? decode_valid(a_text, i) : Policy::Decode(a_text, i);
+			const auto cls = Policy::Resolve(LineBreak::GetClass(cp));
+
+			if (const auto brk = breaker.Next(cls); brk != LineBreak::Break::kNone) {
+				close_segment(start);
+				if (brk == LineBreak::Break::kMandatory) {
+					close_line();
+				}
+			}
+
+			switch (cls) {
+			case LineBreak::Class::kBK:
+			case LineBreak::Class::kCR:
+			case LineBreak::Class::kLF:
+			case LineBreak::Class::kZW:
+				continue;
+			case LineBreak::Class::kSP:
+				segmentWidth += a_advances.GetAdvance(cp);
+				continue;
+			default:
+				break;
+			}
+
+			const auto advance = a_advances.GetAdvance(cp);
+
+			// nothing to break at and too wide on its own, split before this character unless it is a mark
+			if (contentEnd > segmentStart && contentWidth + advance > a_maxWidth && cls != LineBreak::Class::kCM) {
+				close_segment(start);
+				close_line();
+			}
+
+			segmentWidth += advance;
+			contentWidth = segmentWidth;
+			contentEnd = i;
+		}
+
+		close_segment(a_text.size());
+		close_line();
+	}
+
+	Script GetScript(Language a_language)
+	{
+		switch (a_language) {
+		case Language::kJapanese:
+			return Script::kJapanese;
+		case Language::kChinese:
+			return Script::kCJK;
+		case Language::kRussian:
+			return Script::kCyrillic;
+		default:
+			return Script::kLatin;
+		}
+	}
+
+	Script GetScript(Language a_language, std::string_view a_text)
+	{
+		const auto script = GetScript(a_language);
+		if (script == Script::kLatin || script == Script::kCyrillic) {
+			if (!UTF8::IsASCII(a_text) && UTF8::ContainsCJK(a_text)) {
+				return Script::kCJK;
+			}
+		}
+		return script;
+	}
+
+	float GetMaxWidth(std::string_view a_text, std::uint32_t a_maxChars, const GlyphAdvanceTable& a_advances)
+	{
+		if (UTF8::CountCodePoints(a_text) <= a_maxChars) {
+			return std::numeric_limits<float>::infinity();
+		}
+		return a_maxChars * a_advances.GetAverageAdvance();
+	}
+
+	std::vector<Line> Wrap(Script a_script, std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances)
+	{
+		std::vector<Line> lines;
+		Wrap(a_script, a_text, a_maxWidth, a_advances, lines);
+		return lines;
+	}
+
+	template <bool Valid>
+	void Wrap(Script a_script, std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances, std::vector<Line>& a_lines)
+	{
+		switch (a_script) {
+		case Script::kCyrillic:
+			return Wrap<Script::kCyrillic, Valid>(a_text, a_maxWidth, a_advances, a_lines);
+		case Script::kCJK:
+			return Wrap<Script::kCJK, Valid>(a_text, a_maxWidth, a_advances, a_lines);
+		case Script::kJapanese:
+			return Wrap<Script::kJapanese, Valid>(a_text, a_maxWidth, a_advances, a_lines);
+		default:
+			return Wrap<Script::kLatin, Valid>(a_text, a_maxWidth, a_advances, a_lines);
+		}
+	}
+
+	void Wrap(Script a_script, std::string_view a_text, float a_maxWidth, const GlyphAdvanceTable& a_advances, std::vector<Line>& a_lines)
+	{
+		// nearly every subtitle is valid and decoded without checking each sequence, anything else one byte at a time
+		if (UTF8::IsValid(a_text)) {
+			return Wrap<true>(a_script, a_text, a_maxWidth, a_advances, a_lines);
+		}
+		return Wrap<false>(a_script, a_text, a_maxWidth, a_advances, a_lines);
+	}
+
+	WrappedText::WrappedText(std::string_view a_text, std::span<const Line> a_lines) :
+		lineCount(static_cast<std::uint32_t>(a_lines.size())),
+		textLength(static_cast<std::uint32_t>(a_text.size()))
+	{
+		if (a_text.empty()) {
+			lineCount = 0;
+			return;
+		}
+
+		// the text goes in the lines after the last one, with its terminator
+		const auto textLines = (a_text.size() + sizeof(Line)) / sizeof(Line);
+		storage = std::make_unique_for_overwrite<Line[]>(lineCount + textLines);
+
+		std::ranges::copy(a_lines, storage.get());
+		auto text = reinterpret_cast<char*>(storage.get() + lineCount);
+		std::ranges::copy(a_text, text);
+		text[a_text.size()] = '\0';
+	}
+
+	std::string_view WrappedText::GetText() const
+	{
+		return storage ? std::string_view(reinterpret_cast<const char*>(storage.get() + lineCount), textLength) : ""sv;
+	}
+
+	std::span<const Line> WrappedText::GetLines() const
+	{
+		return { storage.get(), lineCount };
+	}
+
+	std::size_t WrappedText::GetMemoryUsage() const
+	{
+		return storage ? (lineCount + (textLength + sizeof(Line)) / sizeof(Line)) * sizeof(Line) : 0;
+	}
+}
@@ -0,0 +1,373 @@
+#include "UTF8.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#	define UTF8_X64
+#	include <immintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#endif
+
+// functions defined between these may use the instruction set, whatever the build targets
+#if defined(__clang__)
+#	define UTF8_PRAGMA(a_pragma) _Pragma(#a_pragma)
+#	define UTF8_TARGET_BEGIN(a_target) UTF8_PRAGMA(clang attribute push(__attribute__((target(a_target))), apply_to = function))
+#	define UTF8_TARGET_END UTF8_PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+#	define UTF8_PRAGMA(a_pragma) _Pragma(#a_pragma)
+#	define UTF8_TARGET_BEGIN(a_target) UTF8_PRAGMA(GCC push_options) UTF8_PRAGMA(GCC target(a_target))
+#	define UTF8_TARGET_END UTF8_PRAGMA(GCC pop_options)
+#else
+// MSVC lets any function use any intrinsic
+#	define UTF8_TARGET_BEGIN(a_target)
+#	define UTF8_TARGET_END
+#endif
+
+namespace UTF8
+{
+	namespace
+	{
+		bool is_cjk(char32_t a_codePoint)
+		{
+			return (a_codePoint >= 0x3040 && a_codePoint <= 0x30FF) ||  // kana
+			       (a_codePoint >= 0x3400 && a_codePoint <= 0x4DBF) ||
+			       (a_codePoint >= 0x4E00 && a_codePoint <= 0x9FFF) ||
+			       (a_codePoint >= 0xAC00 && a_codePoint <= 0xD7AF) ||  // hangul
+			       (a_codePoint >= 0xF900 && a_codePoint <= 0xFAFF) ||
+			       (a_codePoint >= 0x20000 && a_codePoint <= 0x2FA1F);
+		}
+
+		// validates one sequence starting at a non-ASCII byte, returns its length or 0
+		std::size_t validate_sequence(std::string_view a_text, std::size_t a_pos, char32_t& a_codePoint)
+		{
+			const auto byte = [&](std::size_t a_offset) { return static_cast<unsigned char>(a_text[a_pos + a_offset]); };
+
+			const auto lead = byte(0);
+
+			std::size_t length;
+			char32_t    min;
+			if (lead >= 0xC2 && lead <= 0xDF) {
+				length = 2;
+				min = 0x80;
+				a_codePoint = lead & 0x1F;
+			} else if (lead >= 0xE0 && lead <= 0xEF) {
+				length = 3;
+				min = 0x800;
+				a_codePoint = lead & 0x0F;
+			} else if (lead >= 0xF0 && lead <= 0xF4) {
+				length = 4;
+				min = 0x10000;
+				a_codePoint = lead & 0x07;
+			} else {
+				return 0;
+			}
+
+			if (a_pos + length > a_text.size()) {
+				return 0;
+			}
+
+			for (std::size_t i = 1; i < length; ++i) {
+				if ((byte(i) & 0xC0) != 0x80) {
+					return 0;
+				}
+				a_codePoint = (a_codePoint << 6) | (byte(i) & 0x3F);
+			}
+
+			if (a_codePoint < min || a_codePoint > 0x10FFFF || (a_codePoint >= 0xD800 && a_codePoint <= 0xDFFF)) {
+				return 0;
+			}
+
+			return length;
+		}
+
+		// SWAR on 8 bytes, the masks are gathered with a multiply. multi-byte sequences are validated one at a time
+		namespace swar
+		{
+			using Vector = std::uint64_t;
+
+			constexpr std::size_t   vectorSize = 8;
+			constexpr std::uint64_t highMask = 0x8080808080808080;
+
+			Vector load(const char* a_data)
+			{
+				Vector result;
+				std::memcpy(&result, a_data, sizeof(result));
+				return result;
+			}
+			std::uint32_t gather(std::uint64_t a_highBits) { return static_cast<std::uint32_t>(((a_highBits & highMask) * 0x0002040810204081) >> 56); }
+			// one bit per byte, set when the high bit is
+			std::uint32_t high_bits(Vector a_vector) { return gather(a_vector); }
+			// set for lead bytes 0xE3 and up, the first byte of everything from U+3000
+			std::uint32_t wide_leads(Vector a_vector) { return gather(a_vector & ((a_vector & ~highMask) + 0x1D1D1D1D1D1D1D1D)); }
+			// set for ASCII and lead bytes, everything but 10xxxxxx
+			std::uint32_t leads(Vector a_vector) { return gather(~(a_vector & ~(a_vector << 1))); }
+
+			bool IsASCII(std::string_view a_text)
+			{
+				std::size_t i = 0;
+
+				for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+					if (high_bits(load(a_text.data() + i))) {
+						return false;
+					}
+				}
+
+				for (; i < a_text.size(); ++i) {
+					if (static_cast<unsigned char>(a_text[i]) & 0x80) {
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			bool IsValid(std::string_view a_text)
+			{
+				std::size_t i = 0;
+				while (i < a_text.size()) {
+					// skip ASCII a block at a time, stop at the block holding the next multi-byte sequence
+					if (i + vectorSize <= a_text.size()) {
+						if (const auto mask = high_bits(load(a_text.data() + i)); mask == 0) {
+							i += vectorSize;
+							continue;
+						} else {
+							i += std::countr_zero(mask);
+						}
+					}
+
+					if (static_cast<unsigned char>(a_text[i]) < 0x80) {
+						++i;
+						continue;
+					}
+
+					char32_t   cp;
+					const auto length = validate_sequence(a_text, i, cp);
+					if (length == 0) {
+						return false;
+					}
+					i += length;
+				}
+
+				return true;
+			}
+
+			std::size_t CountCodePoints(std::string_view a_text)
+			{
+				std::size_t count = 0;
+				std::size_t i = 0;
+
+				for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+					count += std::popcount(leads(load(a_text.data() + i)));
+				}
+
+				for (; i < a_text.size(); ++i) {
+					count += (static_cast<unsigned char>(a_text[i]) & 0xC0) != 0x80;
+				}
+
+				return count;
+			}
+
+			bool ContainsCJK(std::string_view a_text)
+			{
+				// every range starts at or above U+3000, so only lead bytes 0xE3 and up need decoding
+				const auto check = [&](std::size_t a_pos) {
+					char32_t cp;
+					return validate_sequence(a_text, a_pos, cp) != 0 && is_cjk(cp);
+				};
+
+				std::size_t i = 0;
+
+				for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+					for (auto mask = wide_leads(load(a_text.data() + i)); mask; mask &= mask - 1) {
+						if (check(i + std::countr_zero(mask))) {
+							return true;
+						}
+					}
+				}
+
+				for (; i < a_text.size(); ++i) {
+					if (static_cast<unsigned char>(a_text[i]) >= 0xE3 && check(i)) {
+						return true;
+					}
+				}
+
+				return false;
+			}
+		}
+
+#if defined(UTF8_X64)
+		UTF8_TARGET_BEGIN("sse4.2")
+		namespace sse42
+		{
+			using Vector = __m128i;
+
+			constexpr std::size_t vectorSize = 16;
+
+			Vector        load(const char* a_data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_data)); }
+			Vector        splat(std::uint8_t a_value) { return _mm_set1_epi8(static_cast<char>(a_value)); }
+			Vector        bit_and(Vector a_lhs, Vector a_rhs) { return _mm_and_si128(a_lhs, a_rhs); }
+			Vector        bit_or(Vector a_lhs, Vector a_rhs) { return _mm_or_si128(a_lhs, a_rhs); }
+			Vector        bit_xor(Vector a_lhs, Vector a_rhs) { return _mm_xor_si128(a_lhs, a_rhs); }
+			Vector        saturating_sub(Vector a_lhs, Vector a_rhs) { return _mm_subs_epu8(a_lhs, a_rhs); }
+			bool          any(Vector a_vector) { return !_mm_testz_si128(a_vector, a_vector); }
+			Vector        high_nibbles(Vector a_vector) { return _mm_and_si128(_mm_srli_epi16(a_vector, 4), splat(0x0F)); }
+			Vector        low_nibbles(Vector a_vector) { return _mm_and_si128(a_vector, splat(0x0F)); }
+			Vector        lookup(Vector a_nibbles, const std::array<std::uint8_t, 16>& a_table) { return _mm_shuffle_epi8(load(reinterpret_cast<const char*>(a_table.data())), a_nibbles); }
+			// the input shifted by N bytes, the last N of the previous block shifted in
+			Vector        previous1(Vector a_input, Vector a_previous) { return _mm_alignr_epi8(a_input, a_previous, 15); }
+			Vector        previous2(Vector a_input, Vector a_previous) { return _mm_alignr_epi8(a_input, a_previous, 14); }
+			Vector        previous3(Vector a_input, Vector a_previous) { return _mm_alignr_epi8(a_input, a_previous, 13); }
+			std::uint32_t high_bits(Vector a_vector) { return static_cast<std::uint32_t>(_mm_movemask_epi8(a_vector)); }
+			std::uint32_t wide_leads(Vector a_vector) { return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(a_vector, splat(0xE3)), a_vector))); }
+			std::uint32_t leads(Vector a_vector) { return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(a_vector, splat(0xBF)))); }
+
+#	include "UTF8Kernel.inl"
+		}
+		UTF8_TARGET_END
+
+		UTF8_TARGET_BEGIN("avx2")
+		namespace avx2
+		{
+			using Vector = __m256i;
+
+			constexpr std::size_t vectorSize = 32;
+
+			Vector        load(const char* a_data) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_data)); }
+			Vector        splat(std::uint8_t a_value) { return _mm256_set1_epi8(static_cast<char>(a_value)); }
+			Vector        bit_and(Vector a_lhs, Vector a_rhs) { return _mm256_and_si256(a_lhs, a_rhs); }
+			Vector        bit_or(Vector a_lhs, Vector a_rhs) { return _mm256_or_si256(a_lhs, a_rhs); }
+			Vector        bit_xor(Vector a_lhs, Vector a_rhs) { return _mm256_xor_si256(a_lhs, a_rhs); }
+			Vector        saturating_sub(Vector a_lhs, Vector a_rhs) { return _mm256_subs_epu8(a_lhs, a_rhs); }
+			bool          any(Vector a_vector) { return !_mm256_testz_si256(a_vector, a_vector); }
+			Vector        high_nibbles(Vector a_vector) { return _mm256_and_si256(_mm256_srli_epi16(a_vector, 4), splat(0x0F)); }
+			Vector        low_nibbles(Vector a_vector) { return _mm256_and_si256(a_vector, splat(0x0F)); }
+			// the same table in both lanes, the shuffle stays within each
+			Vector        lookup(Vector a_nibbles, const std::array<std::uint8_t, 16>& a_table) { return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_table.data()))), a_nibbles); }
+			// the low lane of the input paired with the high lane of the previous block, then shifted per lane
+			Vector        previous_lanes(Vector a_input, Vector a_previous) { return _mm256_permute2x128_si256(a_previous, a_input, 0x21); }
+			Vector        previous1(Vector a_input, Vector a_previous) { return _mm256_alignr_epi8(a_input, previous_lanes(a_input, a_previous), 15); }
+			Vector        previous2(Vector a_input, Vector a_previous) { return _mm256_alignr_epi8(a_input, previous_lanes(a_input, a_previous), 14); }
+			Vector        previous3(Vector a_input, Vector a_previous) { return _mm256_alignr_epi8(a_input, previous_lanes(a_input, a_previous), 13); }
+			std::uint32_t high_bits(Vector a_vector) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(a_vector)); }
+			std::uint32_t wide_leads(Vector a_vector) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(a_vector, splat(0xE3)), a_vector))); }
+			std::uint32_t leads(Vector a_vector) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(a_vector, splat(0xBF)))); }
+
+#	include "UTF8Kernel.inl"
+		}
+		UTF8_TARGET_END
+#endif
+
+		struct KernelFunctions
+		{
+			bool (*isASCII)(std::string_view);
+			bool (*isValid)(std::string_view);
+			std::size_t (*countCodePoints)(std::string_view);
+			bool (*containsCJK)(std::string_view);
+		};
+
+		const KernelFunctions& get_functions(Kernel a_kernel)
+		{
+			static constexpr KernelFunctions swarFunctions{ swar::IsASCII, swar::IsValid, swar::CountCodePoints, swar::ContainsCJK };
+#if defined(UTF8_X64)
+			static constexpr KernelFunctions sse42Functions{ sse42::IsASCII, sse42::IsValid, sse42::CountCodePoints, sse42::ContainsCJK };
+			static constexpr KernelFunctions avx2Functions{ avx2::IsASCII, avx2::IsValid, avx2::CountCodePoints, avx2::ContainsCJK };
+
+			switch (a_kernel) {
+			case Kernel::kSSE42:
+				return sse42Functions;
+			case Kernel::kAVX2:
+				return avx2Functions;
+			default:
+				break;
+			}
+#endif
+			return swarFunctions;
+		}
+
+		bool cpu_supports(Kernel a_kernel)
+		{
+#if defined(UTF8_X64)
+#	if defined(_MSC_VER)
+			std::array<int, 4> info{};
+			__cpuid(info.data(), 0);
+			const auto maxLeaf = info[0];
+			__cpuid(info.data(), 1);
+			const bool sse42 = info[2] & (1 << 20);
+			// AVX also needs the OS to save the upper halves of the registers
+			const bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+			// leaf 7 returns garbage on CPUs that stop short of it
+			bool avx2 = false;
+			if (avx && maxLeaf >= 7) {
+				__cpuidex(info.data(), 7, 0);
+				avx2 = info[1] & (1 << 5);
+			}
+#	else
+			__builtin_cpu_init();
+			const bool sse42 = __builtin_cpu_supports("sse4.2");
+			const bool avx2 = __builtin_cpu_supports("avx2");
+#	endif
+			switch (a_kernel) {
+			case Kernel::kSSE42:
+				return sse42;
+			case Kernel::kAVX2:
+				return avx2;
+			default:
+				break;
+			}
+#endif
+			return a_kernel == Kernel::kSWAR;
+		}
+
+		struct ActiveKernel
+		{
+			Kernel                 kernel;
+			const KernelFunctions* functions;
+		};
+
+		// the best the CPU supports until a test picks another
+		ActiveKernel& get_active()
+		{
+			static ActiveKernel active = [] {
+				const auto kernel = IsSupported(Kernel::kAVX2) ? Kernel::kAVX2 : IsSupported(Kernel::kSSE42) ? Kernel::kSSE42 : Kernel::kSWAR;
+				return ActiveKernel{ kernel, &get_functions(kernel) };
+			}();
+			return active;
+		}
+	}
+
+	bool IsASCII(std::string_view a_text)
+	{
+		return get_active().functions->isASCII(a_text);
+	}
+
+	bool IsValid(std::string_view a_text)
+	{
+		return get_active().functions->isValid(a_text);
+	}
+
+	std::size_t CountCodePoints(std::string_view a_text)
+	{
+		return get_active().functions->countCodePoints(a_text);
+	}
+
+	bool ContainsCJK(std::string_view a_text)
+	{
+		return get_active().functions->containsCJK(a_text);
+	}
+
+	bool IsSupported(Kernel a_kernel)
+	{
+		static const std::array supported{ cpu_supports(Kernel::kSWAR), cpu_supports(Kernel::kSSE42), cpu_supports(Kernel::kAVX2) };
+		return supported[std::to_underlying(a_kernel)];
+	}
+
+	Kernel GetKernel()
+	{
+		return get_active().kernel;
+	}
+
+	void SetKernel(Kernel a_kernel)
+	{
+		get_active() = { a_kernel, &get_functions(a_kernel) };
+	}
+}
@@ -0,0 +1,190 @@
+// One vector kernel, included by UTF8.cpp once per instruction set after that set's Vector operations.
+// Validation follows Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte": every byte is paired
+// with the one before it, three nibble lookups each flag the errors the pair could be part of, and an error is a flag
+// all three agree on. Bytes that must continue a 3 or 4 byte sequence are found from the bytes two and three back.
+
+// errors a (previous, current) byte pair can be part of
+constexpr std::uint8_t tooShort = 1 << 0;      // lead byte followed by ASCII or another lead
+constexpr std::uint8_t tooLong = 1 << 1;       // ASCII followed by a continuation
+constexpr std::uint8_t overlong3 = 1 << 2;     // E0 80-9F
+constexpr std::uint8_t tooLarge = 1 << 3;      // F4 90-BF, F5-FF 90-BF
+constexpr std::uint8_t surrogate = 1 << 4;     // ED A0-BF
+constexpr std::uint8_t overlong2 = 1 << 5;     // C0-C1 80-BF
+constexpr std::uint8_t tooLarge1000 = 1 << 6;  // F5-FF 80-8F
+constexpr std::uint8_t overlong4 = 1 << 6;     // F0 80-8F
+constexpr std::uint8_t twoConts = 1 << 7;      // continuation after continuation, an error unless a sequence expects it
+constexpr std::uint8_t carry = tooShort | tooLong | twoConts;  // decided by the high nibbles alone
+
+// by the high nibble of the previous byte
+constexpr std::array<std::uint8_t, 16> previousHigh{
+	tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,  // ASCII
+	twoConts, twoConts, twoConts, twoConts,                                  // continuation
+	tooShort | overlong2,                                                    // C0-CF
+	tooShort,                                                                // D0-DF
+	tooShort | overlong3 | surrogate,                                        // E0-EF
+	tooShort | tooLarge | tooLarge1000 | overlong4                           // F0-FF
+};
+
+// by the low nibble of the previous byte
+constexpr std::array<std::uint8_t, 16> previousLow{
+	carry | overlong3 | overlong2 | overlong4,
+	carry | overlong2,
+	carry,
+	carry,
+	carry | tooLarge,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000 | surrogate,
+	carry | tooLarge | tooLarge1000,
+	carry | tooLarge | tooLarge1000
+};
+
+// by the high nibble of the current byte
+constexpr std::array<std::uint8_t, 16> currentHigh{
+	tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,  // ASCII
+	tooLong | overlong2 | twoConts | overlong3 | tooLarge1000 | overlong4,           // 80-8F
+	tooLong | overlong2 | twoConts | overlong3 | tooLarge,                           // 90-9F
+	tooLong | overlong2 | twoConts | surrogate | tooLarge,                           // A0-BF
+	tooLong | overlong2 | twoConts | surrogate | tooLarge,
+	tooShort, tooShort, tooShort, tooShort  // lead
+};
+
+// a block ending in a lead byte whose sequence doesn't fit is continued by the next one
+constexpr std::array<std::uint8_t, 3> incompleteLimits{ 0xF0 - 1, 0xE0 - 1, 0xC0 - 1 };
+
+Vector get_errors(Vector a_input, Vector a_previous)
+{
+	const auto prev1 = previous1(a_input, a_previous);
+
+	const auto special = bit_and(
+		bit_and(lookup(high_nibbles(prev1), previousHigh), lookup(low_nibbles(prev1), previousLow)),
+		lookup(high_nibbles(a_input), currentHigh));
+
+	// only bytes two after E0-FF or three after F0-FF end up with the high bit set
+	const auto expected = bit_or(
+		saturating_sub(previous2(a_input, a_previous), splat(0xE0 - 0x80)),
+		saturating_sub(previous3(a_input, a_previous), splat(0xF0 - 0x80)));
+
+	return bit_xor(bit_and(expected, splat(0x80)), special);
+}
+
+bool is_incomplete(Vector a_input)
+{
+	static constexpr auto limits = [] {
+		std::array<std::uint8_t, vectorSize> result;
+		result.fill(0xFF);
+		std::ranges::copy(incompleteLimits, result.end() - incompleteLimits.size());
+		return result;
+	}();
+
+	return any(saturating_sub(a_input, load(reinterpret_cast<const char*>(limits.data()))));
+}
+
+// no default member initializers, the implicit constructor would be compiled without the instruction set
+struct ValidationState
+{
+	Vector error;
+	Vector previous;
+	bool   incomplete;  // the previous block ends inside a sequence
+	bool   failed;
+};
+
+void validate(ValidationState& a_state, Vector a_input)
+{
+	if (high_bits(a_input) == 0) {
+		// nothing to pair up, unless a sequence was left open
+		a_state.failed |= a_state.incomplete;
+		a_state.incomplete = false;
+	} else {
+		a_state.error = bit_or(a_state.error, get_errors(a_input, a_state.previous));
+		a_state.incomplete = is_incomplete(a_input);
+	}
+	a_state.previous = a_input;
+}
+
+bool IsASCII(std::string_view a_text)
+{
+	std::size_t i = 0;
+
+	for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+		if (high_bits(load(a_text.data() + i))) {
+			return false;
+		}
+	}
+
+	for (; i < a_text.size(); ++i) {
+		if (static_cast<unsigned char>(a_text[i]) & 0x80) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool IsValid(std::string_view a_text)
+{
+	ValidationState state{ splat(0), splat(0), false, false };
+
+	std::size_t i = 0;
+	for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+		validate(state, load(a_text.data() + i));
+	}
+
+	// the tail padded with ASCII, which also closes a sequence left open at the very end
+	std::array<char, vectorSize> tail{};
+	if (i < a_text.size()) {
+		std::memcpy(tail.data(), a_text.data() + i, a_text.size() - i);
+	}
+	validate(state, load(tail.data()));
+
+	return !state.failed && !any(state.error);
+}
+
+std::size_t CountCodePoints(std::string_view a_text)
+{
+	std::size_t count = 0;
+	std::size_t i = 0;
+
+	for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+		count += std::popcount(leads(load(a_text.data() + i)));
+	}
+
+	for (; i < a_text.size(); ++i) {
+		count += (static_cast<unsigned char>(a_text[i]) & 0xC0) != 0x80;
+	}
+
+	return count;
+}
+
+bool ContainsCJK(std::string_view a_text)
+{
+	// every range starts at or above U+3000, so only lead bytes 0xE3 and up need decoding
+	const auto check = [&](std::size_t a_pos) {
+		char32_t cp;
+		return validate_sequence(a_text, a_pos, cp) != 0 && is_cjk(cp);
+	};
+
+	std::size_t i = 0;
+
+	for (; i + vectorSize <= a_text.size(); i += vectorSize) {
+		for (auto mask = wide_leads(load(a_text.data() + i)); mask; mask &= mask - 1) {
+			if (check(i + std::countr_zero(mask))) {
+				return true;
+			}
+		}
+	}
+
+	for (; i < a_text.size(); ++i) {
+		if (static_cast<unsigned char>(a_text[i]) >= 0xE3 && check(i)) {
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,90 @@
+#include "VisibilityCache.h"
+
+namespace
+{
+	float distance_sq(const RE::NiPoint3& a_lhs, const RE::NiPoint3& a_rhs)
+	{
+		const auto dx = a_lhs.x - a_rhs.x;
+		const auto dy = a_lhs.y - a_rhs.y;
+		const auto dz = a_lhs.z - a_rhs.z;
+		return dx * dx + dy * dy + dz * dz;
+	}
+}
+
+std::optional<RayBatch::Result> VisibilityCache::Get(RE::ObjectRefHandle a_speaker, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_actorPos, Clock::time_point a_now)
+{
+	const auto it = entries.find(a_speaker.native_handle());
+	if (it == entries.end()) {
+		return std::nullopt;
+	}
+
+	const auto& entry = it->second;
+	if (entry.pending != entry.result ||
+		a_now - entry.lastCast > ttl ||
+		distance_sq(entry.cameraPos, a_cameraPos) > cameraThresholdSq ||
+		distance_sq(entry.actorPos, a_actorPos) > actorThresholdSq) {
+		return std::nullopt;
+	}
+
+	++hits;
+	return entry.result;
+}
+
+std::optional<RayBatch::Result> VisibilityCache::GetLast(RE::ObjectRefHandle a_speaker) const
+{
+	const auto it = entries.find(a_speaker.native_handle());
+	return it != entries.end() ? std::optional(it->second.result) : std::nullopt;
+}
+
+std::uint32_t VisibilityCache::GetNextPoint(RE::ObjectRefHandle a_speaker) const
+{
+	const auto it = entries.find(a_speaker.native_handle());
+	return it != entries.end() ? it->second.nextPoint : 0;
+}
+
+VisibilityCache::Clock::duration VisibilityCache::GetAge(RE::ObjectRefHandle a_speaker, Clock::time_point a_now) const
+{
+	const auto it = entries.find(a_speaker.native_handle());
+	return it != entries.end() ? a_now - it->second.lastCast : Clock::duration::max();
+}
+
+RayBatch::Result VisibilityCache::Update(RE::ObjectRefHandle a_speaker, const RayBatch::Query& a_query, const RE::NiPoint3& a_cameraPos, const RE::NiPoint3& a_actorPos, Clock::time_point a_now)
+{
+	++casts;
+
+	const auto [it, inserted] = entries.try_emplace(a_speaker.native_handle(), Entry{ a_query.result, a_query.result, a_now, a_cameraPos, a_actorPos, a_query.nextPoint });
+
+	auto& entry = it->second;
+	if (!inserted) {
+		// flip only when two casts in a row agree
+		if (a_query.result == entry.result || a_query.result == entry.pending) {
+			entry.result = a_query.result;
+		}
+		entry.pending = a_query.result;
+		entry.lastCast = a_now;
+		entry.cameraPos = a_cameraPos;
+		entry.actorPos = a_actorPos;
+		entry.nextPoint = a_query.nextPoint;
+	}
+
+	return entry.result;
+}
+
+void VisibilityCache::RecordRays(std::uint32_t a_count)
+{
+	rays += a_count;
+	windowRays += a_count;
+}
+
+void VisibilityCache::Prune(Clock::time_point a_now)
+{
+	boost::unordered::erase_if(entries, [&](const auto& a_entry) {
+		return a_now - a_entry.second.lastCast > expiry;
+	});
+
+	if (const auto elapsed = a_now - windowStart; elapsed >= rateWindow) {
+		raysPerSecond = windowRays / std::chrono::duration<float>(elapsed).count();
+		windowRays = 0;
+		windowStart = a_now;
+	}
+}
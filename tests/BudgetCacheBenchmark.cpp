@@ -0,0 +1,94 @@
+#include "BudgetCache.h"
+
+#include <benchmark/benchmark.h>
+#include <deque>
+
+// Replays a play session against the processed subtitle cache at several budgets, the way AddProcessedSubtitle
+// uses it: a lookup per heard line, an insert and an eviction pass on a miss, with the last few lines on screen.
+// Lines are drawn from a Zipf distribution, ambient barks and companion chatter repeat, quest dialogue rarely does.
+namespace
+{
+	struct Line
+	{
+		std::uint32_t id;
+		std::uint32_t size;  // laid out size, text plus spans of both languages
+	};
+
+	struct Subtitle
+	{
+		std::uint32_t id;
+	};
+
+	constexpr std::size_t distinctLines = 20000;
+	constexpr std::size_t sessionLength = 100000;
+	constexpr std::size_t onScreen = 4;
+
+	const std::vector<Line>& get_session()
+	{
+		static const auto session = [] {
+			std::mt19937 rng(0);
+
+			std::vector<double> weights(distinctLines);
+			for (std::size_t i = 0; i < distinctLines; ++i) {
+				weights[i] = 1.0 / static_cast<double>(i + 1);
+			}
+			std::discrete_distribution<std::uint32_t> pick(weights.begin(), weights.end());
+
+			std::vector<std::uint32_t> sizes(distinctLines);
+			std::uniform_int_distribution<std::uint32_t> size(400, 3000);
+			for (auto& lineSize : sizes) {
+				lineSize = size(rng);
+			}
+
+			std::vector<Line> result;
+			result.reserve(sessionLength);
+			for (std::size_t i = 0; i < sessionLength; ++i) {
+				const auto id = pick(rng);
+				result.push_back({ id, sizes[id] });
+			}
+			return result;
+		}();
+		return session;
+	}
+
+	void BM_Replay(benchmark::State& a_state)
+	{
+		const auto& session = get_session();
+		const auto  budget = static_cast<std::size_t>(a_state.range(0)) * 1024;
+
+		std::uint64_t hits = 0;
+		std::uint64_t evictions = 0;
+		std::size_t   resident = 0;
+		for (auto _ : a_state) {
+			BudgetCache<std::uint32_t, Subtitle> cache(budget);
+			std::deque<std::uint32_t>            live;
+
+			hits = 0;
+			for (const auto& [id, size] : session) {
+				if (cache.Find(id)) {
+					++hits;
+				} else {
+					cache.Insert(id, { id }, size);
+					cache.Evict([&](const Subtitle& a_subtitle) { return std::ranges::find(live, a_subtitle.id) != live.end(); });
+				}
+
+				live.push_back(id);
+				if (live.size() > onScreen) {
+					live.pop_front();
+				}
+			}
+			evictions = cache.GetEvictions();
+			resident = cache.GetResidentBytes();
+		}
+
+		a_state.SetItemsProcessed(a_state.iterations() * static_cast<std::int64_t>(session.size()));
+		a_state.counters["hitRate%"] = 100.0 * static_cast<double>(hits) / static_cast<double>(session.size());
+		a_state.counters["evictions"] = static_cast<double>(evictions);
+		a_state.counters["residentKB"] = static_cast<double>(resident) / 1024.0;
+	}
+}
+
+// KB, 0 = unbounded. 4096 is the default iCacheBudgetKB
+BENCHMARK(BM_Replay)->Arg(256)->Arg(1024)->Arg(4096)->Arg(16384)->Arg(0)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,74 @@
+#include "BudgetCache.h"
+
+namespace
+{
+	using Cache = BudgetCache<std::uint32_t, std::string>;
+
+	constexpr auto never_live = [](const std::string&) { return false; };
+
+	void test_replace()
+	{
+		Cache cache(1000);
+		cache.Insert(1, "a", 100);
+		cache.Insert(2, "b", 200);
+		Test::Check(cache.GetResidentBytes() == 300);
+
+		cache.Insert(1, "c", 50);
+		Test::Check(cache.GetSize() == 2 && cache.GetResidentBytes() == 250);
+		Test::Check(*cache.Find(1) == "c");
+		Test::Check(cache.Find(3) == nullptr);
+	}
+
+	void test_evict_least_recently_used()
+	{
+		Cache cache(1000);
+		for (std::uint32_t i = 0; i < 10; ++i) {
+			cache.Insert(i, std::to_string(i), 100);
+		}
+		cache.Find(0);  // now the most recent
+
+		// nothing happens until the budget is exceeded
+		cache.Evict(never_live);
+		Test::Check(cache.GetSize() == 10 && cache.GetEvictions() == 0);
+
+		// down to 3/4 of the budget, oldest first
+		cache.Insert(10, "10", 100);
+		cache.Evict(never_live);
+		Test::Check(cache.GetResidentBytes() == 700 && cache.GetEvictions() == 4);
+		Test::Check(cache.Contains(0) && !cache.Contains(1) && !cache.Contains(4) && cache.Contains(5) && cache.Contains(10));
+	}
+
+	void test_evict_skips_live()
+	{
+		Cache cache(300);
+		cache.Insert(1, "live", 200);
+		cache.Insert(2, "b", 200);
+		cache.Evict([](const std::string& a_value) { return a_value == "live"; });
+		Test::Check(cache.Contains(1) && !cache.Contains(2));
+
+		// live values may keep the cache over its budget
+		cache.Insert(3, "live", 200);
+		cache.Evict([](const std::string& a_value) { return a_value == "live"; });
+		Test::Check(cache.GetResidentBytes() == 400 && cache.GetSize() == 2);
+	}
+
+	void test_unbounded()
+	{
+		Cache cache;
+		for (std::uint32_t i = 0; i < 100; ++i) {
+			cache.Insert(i, {}, 1000);
+		}
+		cache.Evict(never_live);
+		Test::Check(cache.GetSize() == 100 && cache.GetEvictions() == 0);
+	}
+}
+
+int main()
+{
+	test_replace();
+	test_evict_least_recently_used();
+	test_evict_skips_live();
+	test_unbounded();
+
+	return Test::Result();
+}
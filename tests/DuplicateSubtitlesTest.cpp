@@ -0,0 +1,296 @@
+#include "DuplicateSubtitles.h"
+#include "LocalizedTables.h"
+
+namespace
+{
+	using SubtitleID = DuplicateSubtitles::SubtitleID;
+
+	struct Input
+	{
+		std::deque<std::string>             strings;  // the maps only view them
+		DuplicateSubtitles::SubtitleToIDMap subToID;
+		DuplicateSubtitles::IDToSubtitleMap idToSub;
+	};
+
+	// few distinct lengths and counts so ties between ids are common
+	Input make_input(std::uint32_t a_seed, std::size_t a_subtitleCount, std::size_t a_idCount)
+	{
+		std::mt19937 rng(a_seed);
+
+		const auto random = [&](std::size_t a_max) { return std::uniform_int_distribution<std::size_t>(0, a_max)(rng); };
+
+		Input input;
+		for (std::size_t i = 0; i < a_idCount; ++i) {
+			const auto id = (static_cast<SubtitleID>(random(3)) << 32) | i;
+			auto&      languages = input.idToSub[id];
+			for (std::size_t lang = 0; lang < std::to_underlying(Language::kTotal); ++lang) {
+				auto& strings = languages[static_cast<Language>(lang)];
+				for (auto n = random(2); n > 0; --n) {
+					strings.insert(input.strings.emplace_back(1 + random(3), static_cast<char>('a' + random(25))));
+				}
+			}
+		}
+
+		std::vector<SubtitleID> ids;
+		for (const auto& [id, languages] : input.idToSub) {
+			ids.push_back(id);
+		}
+		for (std::size_t i = 0; i < a_subtitleCount; ++i) {
+			auto& candidates = input.subToID[input.strings.emplace_back("subtitle " + std::to_string(i))];
+			for (auto n = 1 + random(4); n > 0; --n) {
+				candidates.insert(ids[random(ids.size() - 1)]);
+			}
+		}
+
+		return input;
+	}
+
+	void test_tie_break()
+	{
+		Input input;
+		input.idToSub[1][Language::kEnglish] = { "one", "two" };
+		input.idToSub[2][Language::kEnglish] = { "three" };  // fewest strings
+		input.idToSub[3][Language::kEnglish] = { "four" };
+		input.idToSub[4][Language::kEnglish] = { "a" };
+		input.idToSub[5][Language::kEnglish] = { "bb" };  // same count, longer
+		input.subToID["first"] = { 1, 2, 3 };
+		input.subToID["second"] = { 4, 5 };
+		input.subToID["single"] = { 1 };
+
+		const DuplicateSubtitles duplicates(std::execution::seq, input.subToID, input.idToSub);
+
+		FlatMap<std::string_view, SubtitleID> picks;
+		for (const auto& [subtitle, bestID] : duplicates.GetPicks()) {
+			picks[subtitle->first] = bestID;
+		}
+		Test::Check(picks.size() == 3);
+		Test::Check(picks["first"] == 2);
+		Test::Check(picks["second"] == 5);
+		Test::Check(picks["single"] == 1);
+		Test::Check(&duplicates.GetLanguages(2) == &input.idToSub.at(2));
+	}
+
+	void test_parallel_matches_serial()
+	{
+		for (std::uint32_t seed = 0; seed < 8; ++seed) {
+			const auto input = make_input(seed, 20000, 5000);
+
+			const DuplicateSubtitles serial(std::execution::seq, input.subToID, input.idToSub);
+			const DuplicateSubtitles parallel(std::execution::par, input.subToID, input.idToSub);
+
+			const auto serialPicks = serial.GetPicks();
+			const auto parallelPicks = parallel.GetPicks();
+			if (!Test::Check(serialPicks.size() == input.subToID.size() && parallelPicks.size() == serialPicks.size())) {
+				continue;
+			}
+
+			std::size_t mismatches = 0;
+			for (std::size_t i = 0; i < serialPicks.size(); ++i) {
+				mismatches += serialPicks[i].subtitle != parallelPicks[i].subtitle || serialPicks[i].bestID != parallelPicks[i].bestID;
+			}
+			Test::Check(mismatches == 0);
+
+			for (const auto& [id, languages] : input.idToSub) {
+				Test::Check(&serial.GetLanguages(id) == &languages && &parallel.GetLanguages(id) == &languages);
+			}
+		}
+	}
+
+	// MergeDuplicateSubtitles before the picks were split out, kept verbatim as the reference the picks and rows of a
+	// build must match
+	struct Reference
+	{
+		FlatMap<std::string_view, SubtitleID>                    subtitleToID;
+		FlatMap<SubtitleID, FlatMap<Language, std::string_view>> idToSubtitle;
+	};
+
+	Reference merge_reference(const DuplicateSubtitles::SubtitleToIDMap& a_multiSubToID, const DuplicateSubtitles::IDToSubtitleMap& a_multiIDToSub)
+	{
+		Reference reference;
+		auto&     subtitleToID = reference.subtitleToID;
+		auto&     idToSubtitle = reference.idToSubtitle;
+
+		const auto pick_best_id = [&](const FlatSet<SubtitleID>& ids) {
+			SubtitleID best = *ids.begin();
+
+			std::size_t bestCount = std::numeric_limits<std::size_t>::max();
+			std::size_t bestTotalLen = 0;
+
+			for (SubtitleID id : ids) {
+				const auto& langMap = a_multiIDToSub.at(id);
+
+				std::size_t count = 0;
+				std::size_t totalLen = 0;
+
+				for (const auto& [lang, subs] : langMap) {
+					count += subs.size();
+					for (const auto& s : subs) {
+						totalLen += s.size();
+					}
+				}
+
+				if (count < bestCount || (count == bestCount && totalLen > bestTotalLen)) {
+					best = id;
+					bestCount = count;
+					bestTotalLen = totalLen;
+				}
+			}
+			return best;
+		};
+
+		const auto pick_best_subtitle = [&](SubtitleID bestID) {
+			FlatMap<Language, std::string_view> singleStrings;
+			for (auto& [lang, set] : a_multiIDToSub.at(bestID)) {
+				if (!set.empty()) {
+					singleStrings[lang] = *set.begin();  // take the first string
+				}
+			}
+			return singleStrings;
+		};
+
+		for (auto& [subtitle, ids] : a_multiSubToID) {
+			if (auto [it, result] = subtitleToID.try_emplace(subtitle, pick_best_id(ids)); result) {
+				idToSubtitle.try_emplace(it->second, pick_best_subtitle(it->second));
+			}
+		}
+
+		return reference;
+	}
+
+	struct Corpus
+	{
+		std::deque<std::string>             strings;
+		std::vector<LocalizedTables::Table> partials;
+		std::vector<Language>               languages;
+	};
+
+	// several plugins with .STRINGS and .DLSTRINGS per language. lines come from a small pool so the same english
+	// text turns up under ids of several plugins, and an id in both files of a language has two strings there
+	Corpus make_corpus(std::uint32_t a_seed, std::uint32_t a_pluginCount, std::uint32_t a_idCount)
+	{
+		std::mt19937 rng(a_seed);
+
+		const auto random = [&](std::size_t a_max) { return std::uniform_int_distribution<std::size_t>(0, a_max)(rng); };
+
+		constexpr std::array languages{ Language::kEnglish, Language::kGerman, Language::kFrench };
+
+		Corpus corpus;
+		for (std::uint32_t plugin = 1; plugin <= a_pluginCount; ++plugin) {
+			for (const auto language : languages) {
+				for (std::uint32_t file = 0; file < 2; ++file) {
+					auto& entries = corpus.partials.emplace_back().entries;
+					corpus.languages.push_back(language);
+					for (std::uint32_t i = 0; i < a_idCount; ++i) {
+						if (random(2) != 0) {
+							continue;
+						}
+						const auto  pool = language == Language::kEnglish ? a_idCount / 2 : a_idCount * 2;
+						const auto& text = corpus.strings.emplace_back(std::to_string(std::to_underlying(language)) + " line " + std::to_string(random(pool)));
+						entries.push_back({ (static_cast<SubtitleID>(plugin) << 32) | i, text });
+					}
+				}
+			}
+		}
+		return corpus;
+	}
+
+	void test_matches_baseline()
+	{
+		for (std::uint32_t seed = 0; seed < 8; ++seed) {
+			const auto corpus = make_corpus(seed, 6, 400);
+
+			// merged the way Build does, in load order
+			DuplicateSubtitles::SubtitleToIDMap subToID;
+			DuplicateSubtitles::IDToSubtitleMap idToSub;
+			for (std::size_t i = 0; i < corpus.partials.size(); ++i) {
+				for (const auto& [id, subtitle] : corpus.partials[i].entries) {
+					if (corpus.languages[i] == Language::kEnglish) {
+						subToID[subtitle].emplace(id);
+					}
+					idToSub[id][corpus.languages[i]].emplace(subtitle);
+				}
+			}
+
+			const auto reference = merge_reference(subToID, idToSub);
+
+			// the corpus has what the comparison is about
+			Test::Check(std::ranges::any_of(subToID, [](const auto& a_entry) { return a_entry.second.size() > 1; }));
+			Test::Check(std::ranges::any_of(idToSub, [](const auto& a_entry) {
+				return std::ranges::any_of(a_entry.second, [](const auto& a_language) { return a_language.second.size() > 1; });
+			}));
+
+			const DuplicateSubtitles duplicates(std::execution::par, subToID, idToSub);
+			Test::Check(duplicates.GetPicks().size() == reference.subtitleToID.size());
+
+			std::size_t pickMismatches = 0;
+			for (const auto& [subtitle, bestID] : duplicates.GetPicks()) {
+				pickMismatches += reference.subtitleToID.at(subtitle->first) != bestID;
+			}
+			Test::Check(pickMismatches == 0);
+
+			LocalizedTables tables;
+			tables.Build(corpus.partials, corpus.languages, Language::kEnglish);
+
+			const auto& table = tables.subtitleTable;
+			Test::Check(table.GetIndexedCount() == reference.subtitleToID.size());
+
+			std::size_t rowMismatches = 0;
+			for (const auto& [subtitle, bestID] : reference.subtitleToID) {
+				const auto row = table.FindRow(subtitle);
+				if (row == SubtitleTable::invalidRow || table.GetID(row) != bestID) {
+					++rowMismatches;
+					continue;
+				}
+				const auto& strings = reference.idToSubtitle.at(bestID);
+				for (const auto language : { Language::kGerman, Language::kFrench }) {
+					const auto it = strings.find(language);
+					rowMismatches += table.GetString(row, language) != (it != strings.end() ? it->second : std::string_view{});
+				}
+				rowMismatches += table.GetString(row, Language::kEnglish) != subtitle;
+			}
+			Test::Check(rowMismatches == 0);
+		}
+	}
+
+	// one id with two english strings is the pick for both, each text still finds its translation
+	void test_shared_best_id()
+	{
+		constexpr SubtitleID shared = 0x1'00000001;
+		constexpr SubtitleID other = 0x2'00000001;
+
+		const std::vector<LocalizedTables::Table> partials{
+			{ {}, { { shared, "Hello" } } },                                            // .STRINGS
+			{ {}, { { shared, "Hi" }, { other, "Hi" } } },                              // .DLSTRINGS, and another plugin with the same line
+			{ {}, { { shared, "Hallo" } } },                                            // german
+			{ {}, { { other, "Servus" }, { other, "Grüß Gott" }, { other, "Moin" } } }  // more strings, not picked over the shared id
+		};
+		const std::array languages{ Language::kEnglish, Language::kEnglish, Language::kGerman, Language::kGerman };
+
+		LocalizedTables tables;
+		tables.Build(partials, languages, Language::kEnglish);
+
+		const auto& table = tables.subtitleTable;
+		const auto  hello = table.FindRow("Hello"sv);
+		const auto  hi = table.FindRow("Hi"sv);
+		if (!Test::Check(hello != SubtitleTable::invalidRow && hi != SubtitleTable::invalidRow && hello != hi)) {
+			return;
+		}
+		Test::Check(table.GetIndexedCount() == 2);
+		Test::Check(table.GetID(hello) == shared && table.GetID(hi) == shared);
+		Test::Check(table.GetString(hello, Language::kGerman) == "Hallo" && table.GetString(hi, Language::kGerman) == "Hallo");
+		Test::Check(table.FindRow(shared) == std::min(hello, hi));
+
+		// the other plugin's row is still an alternate of the text it shares
+		Test::Check(tables.alternateRows.contains(hi) && table.GetID(tables.alternateRows.at(hi).front()) == other);
+	}
+}
+
+int main()
+{
+	test_tie_break();
+	test_parallel_matches_serial();
+	test_matches_baseline();
+	test_shared_best_id();
+
+	return Test::Result();
+}
@@ -0,0 +1,204 @@
+#include "LazySubtitleTable.h"
+#include "StringTableBuilder.h"
+
+namespace
+{
+	using SubtitleID = LazySubtitleTable::SubtitleID;
+	using Type = RE::LocalizedStringTable::Type;
+
+	class MemoryStream : public LazySubtitleTable::Stream
+	{
+	public:
+		explicit MemoryStream(std::vector<std::byte> a_data) :
+			data(std::move(a_data))
+		{}
+
+		std::uint64_t GetSize() const override { return data.size(); }
+		void          Seek(std::uint64_t a_position) override { position = a_position; }
+
+		void Read(void* a_buffer, std::uint32_t a_size) override
+		{
+			Test::Check(position + a_size <= data.size());
+			std::memcpy(a_buffer, data.data() + position, a_size);
+			position += a_size;
+		}
+
+	private:
+		// members
+		std::vector<std::byte> data;
+		std::uint64_t          position{ 0 };
+	};
+
+	// files by path, a stream reads the contents the file had when it was opened
+	struct Files
+	{
+		LazySubtitleTable::OpenFunc GetOpenFunc()
+		{
+			return [this](const std::string& a_path) -> std::unique_ptr<LazySubtitleTable::Stream> {
+				++openCount;
+				const auto it = contents.find(a_path);
+				return it != contents.end() ? std::make_unique<MemoryStream>(it->second) : nullptr;
+			};
+		}
+
+		FlatMap<std::string, std::vector<std::byte>> contents;
+		std::uint32_t                                openCount{ 0 };
+	};
+
+	constexpr SubtitleID id(std::uint32_t a_modIndex, std::uint32_t a_stringID) { return (static_cast<SubtitleID>(a_modIndex) << 32) | a_stringID; }
+
+	// english is the index language. plugins 1 and 2 both have "Hello", plugin 1 also has a .STRINGS table
+	void add_files(Files& a_files, LazySubtitleTable& a_table)
+	{
+		a_files.contents = {
+			{ "Strings\\One_en.ILSTRINGS", StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "Goodbye").Add(3, " ").Build() },
+			{ "Strings\\One_en.STRINGS", StringTableBuilder(Type::kStrings).Add(7, "Sign").Build() },
+			{ "Strings\\One_de.ILSTRINGS", StringTableBuilder(Type::kILStrings).Add(1, "Hallo").Add(2, "Tschüss").Build() },
+			{ "Strings\\One_de.STRINGS", StringTableBuilder(Type::kStrings).Add(7, "Schild").Build() },
+			{ "Strings\\Two_en.ILSTRINGS", StringTableBuilder(Type::kILStrings).Add(5, "Hello").Build() },
+			{ "Strings\\Two_de.ILSTRINGS", StringTableBuilder(Type::kILStrings).Add(5, "Servus").Build() }
+		};
+
+		a_table.SetIndexLanguage(Language::kEnglish);
+		for (const auto& [path, modIndex, language, type] : {
+				 std::tuple{ "Strings\\One_en.ILSTRINGS"s, 1u, Language::kEnglish, Type::kILStrings },
+				 std::tuple{ "Strings\\One_en.STRINGS"s, 1u, Language::kEnglish, Type::kStrings },
+				 std::tuple{ "Strings\\One_de.ILSTRINGS"s, 1u, Language::kGerman, Type::kILStrings },
+				 std::tuple{ "Strings\\One_de.STRINGS"s, 1u, Language::kGerman, Type::kStrings },
+				 std::tuple{ "Strings\\Two_en.ILSTRINGS"s, 2u, Language::kEnglish, Type::kILStrings },
+				 std::tuple{ "Strings\\Two_de.ILSTRINGS"s, 2u, Language::kGerman, Type::kILStrings } }) {
+			auto file = a_table.ReadFile(path, type, language == Language::kEnglish);
+			if (Test::Check(file.has_value())) {
+				a_table.AddFile(modIndex, language, std::move(*file));
+			}
+		}
+	}
+
+	void test_read_file()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+
+		files.contents["hashed"] = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "").Add(3, "World").Build();
+		const auto hashed = table.ReadFile("hashed", Type::kILStrings, true);
+		if (Test::Check(hashed.has_value())) {
+			Test::Check(hashed->directory.size() == 3);
+			Test::Check(hashed->hashes.size() == 2);  // blank strings aren't indexed
+			Test::Check(hashed->dataOffset == RE::LocalizedStringTable::headerSize + 3 * 8);
+		}
+
+		// only the header and directory are needed, the data block is never read
+		auto directoryOnly = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "World").Build();
+		directoryOnly.resize(RE::LocalizedStringTable::headerSize + 2 * 8);
+		files.contents["directory"] = directoryOnly;
+		const auto directory = table.ReadFile("directory", Type::kILStrings, false);
+		if (Test::Check(directory.has_value())) {
+			Test::Check(directory->directory.size() == 2 && directory->directory.contains(2));
+			Test::Check(directory->hashes.empty());
+		}
+
+		// a directory past the end of the file, a missing file and a truncated header
+		files.contents["truncated"] = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "World").Build(100);
+		Test::Check(!table.ReadFile("truncated", Type::kILStrings, false));
+		Test::Check(!table.ReadFile("missing", Type::kILStrings, false));
+		files.contents["header"] = std::vector<std::byte>(4);
+		Test::Check(!table.ReadFile("header", Type::kILStrings, true));
+	}
+
+	void test_get_string()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+		add_files(files, table);
+
+		Test::Check(table.GetString(id(1, 1), Language::kGerman) == "Hallo");
+		Test::Check(table.GetString(id(1, 2), Language::kGerman) == "Tschüss");
+		Test::Check(table.GetString(id(1, 7), Language::kGerman) == "Schild");  // null-terminated table
+		Test::Check(table.GetString(id(2, 5), Language::kGerman) == "Servus");
+		Test::Check(!table.GetString(id(1, 9), Language::kGerman));
+		Test::Check(!table.GetString(id(1, 1), Language::kFrench));
+
+		// cached, the file isn't opened again even once it is gone
+		const auto openCount = files.openCount;
+		files.contents.clear();
+		Test::Check(table.GetString(id(1, 1), Language::kGerman) == "Hallo");
+		Test::Check(files.openCount == openCount);
+	}
+
+	// like the eager tables, a translation that is not UTF-8 is left out and an index language line is kept
+	void test_invalid_utf8()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+		add_files(files, table);
+
+		files.contents["Strings\\One_de.ILSTRINGS"] = StringTableBuilder(Type::kILStrings).Add(1, "Hallo").Add(2, "Tsch\xFCss").Build();
+		files.contents["Strings\\One_en.ILSTRINGS"] = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "Caf\xE9").Add(3, " ").Build();
+
+		Test::Check(table.GetString(id(1, 1), Language::kGerman) == "Hallo");
+		Test::Check(!table.GetString(id(1, 2), Language::kGerman));
+		Test::Check(table.GetString(id(1, 2), Language::kEnglish) == "Caf\xE9");
+	}
+
+	void test_find_id()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+		add_files(files, table);
+
+		Test::Check(table.GetIndexedCount() == 3);
+		Test::Check(table.FindID("Goodbye") == id(1, 2));
+		Test::Check(table.FindID("Sign") == id(1, 7));
+		Test::Check(!table.FindID("Unknown"));
+		Test::Check(!table.FindID(" "));
+
+		// both plugins have the line, the first loaded one wins unless the topic's plugins say otherwise
+		const std::array two{ 2u };
+		const std::array oneThenTwo{ 1u, 2u };
+		const std::array missingThenTwo{ 9u, 2u };
+		Test::Check(table.FindID("Hello") == id(1, 1));
+		Test::Check(table.FindID("Hello", two) == id(2, 5));
+		Test::Check(table.FindID("Hello", oneThenTwo) == id(1, 1));
+		Test::Check(table.FindID("Hello", missingThenTwo) == id(2, 5));
+		Test::Check(table.GetString(*table.FindID("Hello", two), Language::kGerman) == "Servus");
+	}
+
+	// only hashes are kept, a match is confirmed against the string the file holds
+	void test_find_id_checks_string()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+		add_files(files, table);
+
+		// plugin 1's table changed since it was indexed, its "Hello" is now something else
+		files.contents["Strings\\One_en.ILSTRINGS"] = StringTableBuilder(Type::kILStrings).Add(1, "Howdy").Add(2, "Goodbye").Build();
+
+		Test::Check(table.FindID("Hello") == id(2, 5));
+		Test::Check(table.FindID("Hello", std::array{ 1u }) == id(2, 5));
+		Test::Check(!table.FindID("Howdy"));  // never indexed
+	}
+
+	void test_clear()
+	{
+		Files             files;
+		LazySubtitleTable table(files.GetOpenFunc());
+		add_files(files, table);
+
+		table.Clear();
+		Test::Check(table.GetIndexedCount() == 0);
+		Test::Check(!table.FindID("Hello"));
+		Test::Check(!table.GetString(id(1, 1), Language::kGerman));
+	}
+}
+
+int main()
+{
+	test_read_file();
+	test_get_string();
+	test_invalid_utf8();
+	test_find_id();
+	test_find_id_checks_string();
+	test_clear();
+
+	return Test::Result();
+}
@@ -0,0 +1,283 @@
+#include "LineBreak.h"
+
+// UAX #14 conformance against the UCD's LineBreakTest.txt, given as the first argument when the build has a copy.
+// Lines using a class the reduced tables do not carry, or whose characters the tables leave at the AL default, are
+// skipped. The file applies LB25 as the regex tailoring of UAX #14 example 7 while the breaker has the pair rules,
+// so boundaries next to NU, PR or PO are not compared either. Those are covered by hand-written cases of the pair
+// rules instead, which always run.
+namespace
+{
+	using LineBreak::Class;
+
+	struct Case
+	{
+		std::vector<char32_t> codePoints;
+		std::vector<bool>     breaks;  // before every code point but the first
+		std::vector<Class>    classes;
+	};
+
+	struct Stats
+	{
+		std::size_t lines{ 0 };
+		std::size_t skippedLines{ 0 };
+		std::size_t boundaries{ 0 };
+		std::size_t skippedBoundaries{ 0 };
+	};
+
+	// the class the rules see, CJ resolves to NS and wide OP is OP outside of LB30
+	Class resolve(Class a_class)
+	{
+		switch (a_class) {
+		case Class::kCJ:
+			return Class::kNS;
+		case Class::kOPW:
+			return Class::kOP;
+		default:
+			return a_class;
+		}
+	}
+
+	std::optional<Class> to_class(std::string_view a_name)
+	{
+		static constexpr std::array<std::pair<std::string_view, Class>, 25> names{ {
+			{ "AL", Class::kAL },
+			{ "BA", Class::kBA },
+			{ "BB", Class::kBB },
+			{ "BK", Class::kBK },
+			{ "CL", Class::kCL },
+			{ "CM", Class::kCM },
+			{ "CP", Class::kCP },
+			{ "CR", Class::kCR },
+			{ "EX", Class::kEX },
+			{ "GL", Class::kGL },
+			{ "HY", Class::kHY },
+			{ "ID", Class::kID },
+			{ "IN", Class::kIN },
+			{ "IS", Class::kIS },
+			{ "LF", Class::kLF },
+			{ "NS", Class::kNS },
+			{ "NU", Class::kNU },
+			{ "OP", Class::kOP },
+			{ "PO", Class::kPO },
+			{ "PR", Class::kPR },
+			{ "QU", Class::kQU },
+			{ "SP", Class::kSP },
+			{ "SY", Class::kSY },
+			{ "WJ", Class::kWJ },
+			{ "ZW", Class::kZW },
+		} };
+
+		const auto it = std::ranges::find(names, a_name, &std::pair<std::string_view, Class>::first);
+		return it != names.end() ? std::optional(it->second) : std::nullopt;
+	}
+
+	// comments name each character's class after LB1 as "(CLASS)" or "(ORIGINAL_CLASS)", test variants add a digit
+	std::vector<std::optional<Class>> parse_classes(std::string_view a_comment)
+	{
+		std::vector<std::optional<Class>> result;
+		for (auto open = a_comment.find('('); open != std::string_view::npos; open = a_comment.find('(', open + 1)) {
+			const auto close = a_comment.find(')', open);
+			if (close == std::string_view::npos) {
+				break;
+			}
+
+			auto name = a_comment.substr(open + 1, close - open - 1);
+			if (name.empty() || !std::ranges::all_of(name, [](char a_ch) { return std::isupper(static_cast<unsigned char>(a_ch)) || std::isdigit(static_cast<unsigned char>(a_ch)) || a_ch == '_'; })) {
+				continue;
+			}
+			if (const auto underscore = name.rfind('_'); underscore != std::string_view::npos) {
+				name.remove_prefix(underscore + 1);
+			}
+			while (!name.empty() && std::isdigit(static_cast<unsigned char>(name.back()))) {
+				name.remove_suffix(1);
+			}
+			result.push_back(to_class(name));
+		}
+		return result;
+	}
+
+	// nullopt for comments, blank lines and cases outside the tables
+	std::optional<Case> parse_case(std::string_view a_line)
+	{
+		constexpr auto noBreak = "\xC3\x97"sv;   // U+00D7
+		constexpr auto canBreak = "\xC3\xB7"sv;  // U+00F7
+
+		const auto hash = a_line.find('#');
+		const auto data = a_line.substr(0, hash);
+		const auto comment = hash != std::string_view::npos ? a_line.substr(hash + 1) : std::string_view{};
+
+		Case result;
+		for (auto token : data | std::views::split(' ')) {
+			const std::string_view text(token.begin(), token.end());
+			if (text.empty() || text == "\t") {
+				continue;
+			}
+			if (text == noBreak || text == canBreak) {
+				if (!result.codePoints.empty()) {
+					result.breaks.push_back(text == canBreak);
+				}
+				continue;
+			}
+			result.codePoints.push_back(static_cast<char32_t>(std::stoul(std::string(text), nullptr, 16)));
+		}
+
+		if (result.codePoints.empty()) {
+			return std::nullopt;
+		}
+		result.breaks.pop_back();  // LB3, always a break at the end
+
+		const auto named = parse_classes(comment);
+		if (named.size() != result.codePoints.size()) {
+			return std::nullopt;
+		}
+		for (std::size_t i = 0; i < named.size(); ++i) {
+			const auto cls = LineBreak::GetClass(result.codePoints[i]);
+			if (!named[i] || *named[i] != resolve(cls)) {
+				return std::nullopt;
+			}
+			result.classes.push_back(cls);
+		}
+
+		return result;
+	}
+
+	// '-' where a break is prohibited and '|' where one is allowed, for every boundary between code points
+	std::string get_breaks(std::u32string_view a_text)
+	{
+		LineBreak::Breaker breaker;
+		breaker.Next(LineBreak::GetClass(a_text.front()));
+
+		std::string result;
+		for (const auto cp : a_text.substr(1)) {
+			result.push_back(breaker.Next(LineBreak::GetClass(cp)) == LineBreak::Break::kNone ? '-' : '|');
+		}
+		return result;
+	}
+
+	// LB23-LB25 as the pairs the breaker implements, with the characters that carry the classes in game text
+	void test_numbers()
+	{
+		static constexpr std::array<std::pair<std::u32string_view, std::string_view>, 32> cases{ {
+			// LB23, (AL) x NU, NU x (AL)
+			{ U"a5", "-" },
+			{ U"5a", "-" },
+			// LB23a, PR x ID, ID x PO
+			{ U"$字", "-" },
+			{ U"字%", "-" },
+			// LB24, (PR | PO) x (AL), (AL) x (PR | PO)
+			{ U"$a", "-" },
+			{ U"%a", "-" },
+			{ U"a$", "-" },
+			{ U"a%", "-" },
+			// LB25
+			{ U"5%", "-" },
+			{ U"5$", "-" },
+			{ U"%(", "-" },
+			{ U"%5", "-" },
+			{ U"$(", "-" },
+			{ U"$5", "-" },
+			{ U"-5", "-" },
+			{ U",5", "-" },
+			{ U"12", "-" },
+			{ U"/5", "-" },
+			// whole numbers
+			{ U"$1,000.50", "--------" },
+			{ U"-12.5%", "-----" },
+			{ U"€20", "--" },
+			{ U"45°", "--" },
+			{ U"1/2", "--" },
+			{ U"$(5)", "---" },
+			// LB18, spaces still allow a break
+			{ U"$ 5", "-|" },
+			{ U"5 %", "-|" },
+			// no pair rule
+			{ U"字5", "|" },
+			{ U"5字", "|" },
+			{ U"%字", "|" },
+			{ U"$$", "|" },
+			{ U"%%", "|" },
+			{ U"5%a", "--" },
+		} };
+
+		for (std::size_t i = 0; i < cases.size(); ++i) {
+			const auto& [text, breaks] = cases[i];
+			if (const auto result = get_breaks(text); !Test::Check(result == breaks)) {
+				std::fprintf(stderr, "case %zu: expected %s, got %s\n", i, std::string(breaks).c_str(), result.c_str());
+			}
+		}
+	}
+
+	bool is_number(Class a_class)
+	{
+		return a_class == Class::kNU || a_class == Class::kPR || a_class == Class::kPO;
+	}
+
+	// returns false on a mismatch
+	bool check_case(const Case& a_case, std::size_t a_lineNumber, Stats& a_stats)
+	{
+		LineBreak::Breaker breaker;
+		breaker.Next(a_case.classes[0]);
+
+		bool  passed = true;
+		Class base = a_case.classes[0];  // LB9, marks do not change what the next character sees
+		for (std::size_t i = 1; i < a_case.codePoints.size(); ++i) {
+			const auto cls = a_case.classes[i];
+			const auto brk = breaker.Next(cls) != LineBreak::Break::kNone;
+
+			if (is_number(resolve(base)) || is_number(resolve(cls))) {
+				++a_stats.skippedBoundaries;
+			} else {
+				++a_stats.boundaries;
+				if (brk != a_case.breaks[i - 1]) {
+					std::fprintf(stderr, "line %zu: expected %s before U+%04X, position %zu\n", a_lineNumber, a_case.breaks[i - 1] ? "a break" : "no break", static_cast<unsigned>(a_case.codePoints[i]), i);
+					passed = false;
+				}
+			}
+
+			if (cls != Class::kCM || brk) {
+				base = cls;
+			}
+		}
+		return passed;
+	}
+
+	void test_conformance(const std::filesystem::path& a_path)
+	{
+		std::ifstream file(a_path);
+
+		Stats       stats;
+		std::string line;
+		std::size_t lineNumber = 0;
+		while (std::getline(file, line)) {
+			++lineNumber;
+			if (line.empty() || line.front() == '#') {
+				continue;
+			}
+
+			const auto testCase = parse_case(line);
+			if (!testCase) {
+				++stats.skippedLines;
+				continue;
+			}
+
+			++stats.lines;
+			Test::Check(check_case(*testCase, lineNumber, stats));
+		}
+
+		std::printf("%zu lines checked, %zu skipped, %zu boundaries compared, %zu next to numbers skipped\n", stats.lines, stats.skippedLines, stats.boundaries, stats.skippedBoundaries);
+		Test::Check(stats.lines > 0);
+	}
+}
+
+int main(int a_argc, char** a_argv)
+{
+	test_numbers();
+
+	if (a_argc < 2 || !std::filesystem::exists(a_argv[1])) {
+		std::fprintf(stderr, "LineBreakTest.txt not found, conformance skipped\n");
+	} else {
+		test_conformance(a_argv[1]);
+	}
+
+	return Test::Result();
+}
@@ -0,0 +1,130 @@
+#include "LocalizedTables.h"
+#include "StringTableBuilder.h"
+
+#include <benchmark/benchmark.h>
+
+// Startup with and without the localization cache, for 1 to 3 configured languages besides the game language.
+// Cold parses every table, builds and writes the cache, as on the first run after a load order change.
+// Warm reads the tables back from the cache file's bytes, the file itself is mapped and not timed.
+// Missing is a warm load of a cache made with the game language only, the configured languages are then
+// parsed and added the way LoadLanguages does when they are changed in game.
+namespace
+{
+	using Type = RE::LocalizedStringTable::Type;
+	using ParsedTable = LocalizedTables::Table;
+
+	constexpr auto gameLanguage = Language::kEnglish;
+	constexpr std::array configuredLanguages{ Language::kGerman, Language::kFrench, Language::kSpanish };
+
+	struct Table
+	{
+		std::vector<std::byte> buffer;
+		std::uint32_t          modIndex;
+		Language               language;
+	};
+
+	// the base game, its six DLC and some small mods, the game language first
+	std::vector<Table> get_tables(std::size_t a_languageCount)
+	{
+		std::vector<std::uint32_t> entryCounts{ 40000, 6000, 4000, 3000, 2000, 2000, 1500 };
+		for (std::uint32_t i = 0; i < 30; ++i) {
+			entryCounts.push_back(50 + (i * 137) % 800);
+		}
+
+		std::vector<Table> tables;
+		for (std::size_t language = 0; language <= a_languageCount; ++language) {
+			const auto lang = language == 0 ? gameLanguage : configuredLanguages[language - 1];
+			for (std::uint32_t i = 0; i < entryCounts.size(); ++i) {
+				tables.emplace_back(StringTableBuilder::Generate(Type::kILStrings, entryCounts[i], i * 4 + static_cast<std::uint32_t>(language)), i, lang);
+			}
+		}
+		return tables;
+	}
+
+	// the entries view into a_tables, which stand in for the buffers LocalizedSubtitles reads
+	void parse(std::span<const Table> a_tables, std::vector<ParsedTable>& a_partials, std::vector<Language>& a_languages)
+	{
+		a_partials.resize(a_tables.size());
+		std::transform(std::execution::par, a_tables.begin(), a_tables.end(), a_partials.begin(), [](const Table& a_table) {
+			return ParsedTable{ {}, StringTableParser::Parse(a_table.buffer, Type::kILStrings, a_table.modIndex).value_or(std::vector<StringTableParser::Entry>{}) };
+		});
+
+		a_languages.clear();
+		for (const auto& table : a_tables) {
+			a_languages.push_back(table.language);
+		}
+	}
+
+	std::string write_cache(std::span<const Table> a_tables)
+	{
+		std::vector<ParsedTable> partials;
+		std::vector<Language>    languages;
+		parse(a_tables, partials, languages);
+
+		LocalizedTables tables;
+		tables.Build(partials, languages, gameLanguage);
+
+		std::ostringstream stream;
+		tables.Write(stream);
+		return std::move(stream).str();
+	}
+
+	void BM_ColdStartup(benchmark::State& a_state)
+	{
+		const auto tables = get_tables(static_cast<std::size_t>(a_state.range(0)));
+
+		std::size_t cacheSize = 0;
+		for (auto _ : a_state) {
+			const auto cache = write_cache(tables);
+			cacheSize = cache.size();
+			benchmark::DoNotOptimize(cache.data());
+		}
+
+		a_state.counters["cacheKB"] = static_cast<double>(cacheSize) / 1024.0;
+	}
+
+	void BM_WarmStartup(benchmark::State& a_state)
+	{
+		const auto cache = write_cache(get_tables(static_cast<std::size_t>(a_state.range(0))));
+		const auto bytes = std::as_bytes(std::span(cache));
+
+		for (auto _ : a_state) {
+			LocalizedTables tables;
+			if (!tables.Read(bytes)) {
+				a_state.SkipWithError("cache rejected");
+				break;
+			}
+			benchmark::DoNotOptimize(tables.subtitleTable.GetRowCount());
+		}
+
+		a_state.SetBytesProcessed(a_state.iterations() * static_cast<std::int64_t>(bytes.size()));
+	}
+
+	void BM_WarmStartupMissingLanguages(benchmark::State& a_state)
+	{
+		const auto tables = get_tables(static_cast<std::size_t>(a_state.range(0)));
+		const auto gameTableCount = tables.size() / (static_cast<std::size_t>(a_state.range(0)) + 1);
+
+		const auto cache = write_cache(std::span(tables).first(gameTableCount));
+		const auto bytes = std::as_bytes(std::span(cache));
+
+		std::vector<ParsedTable> partials;
+		std::vector<Language>    languages;
+		for (auto _ : a_state) {
+			LocalizedTables localizedTables;
+			if (!localizedTables.Read(bytes)) {
+				a_state.SkipWithError("cache rejected");
+				break;
+			}
+			parse(std::span(tables).subspan(gameTableCount), partials, languages);
+			localizedTables.AddTranslations(LocalizedTables::GetTranslations(partials, languages));
+			benchmark::DoNotOptimize(localizedTables.subtitleTable.GetRowCount());
+		}
+	}
+}
+
+BENCHMARK(BM_ColdStartup)->DenseRange(1, 3)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WarmStartup)->DenseRange(1, 3)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WarmStartupMissingLanguages)->DenseRange(1, 3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+#include "LocalizedStringTable.h"
+
+#include "StringTableBuilder.h"
+#include "StringTableParser.h"
+
+namespace
+{
+	using Type = RE::LocalizedStringTable::Type;
+
+	struct Entry
+	{
+		std::uint32_t    stringID;
+		std::string_view string;
+	};
+
+	std::vector<Entry> read_all(const RE::LocalizedStringTable& a_table)
+	{
+		std::vector<Entry> result;
+		a_table.ForEachString([&](std::uint32_t a_stringID, std::string_view a_string) {
+			result.push_back({ a_stringID, a_string });
+		});
+		return result;
+	}
+
+	void test_well_formed()
+	{
+		for (const auto type : { Type::kStrings, Type::kDLStrings, Type::kILStrings }) {
+			const auto buffer = StringTableBuilder(type).Add(1, "Hello").Add(7, "").Add(0xFFFFFFFF, "Привет").Build();
+
+			const RE::LocalizedStringTable table(buffer, type);
+			Test::Check(table.IsValid());
+			Test::Check(table.GetEntryCount() == 3);
+			Test::Check(table.GetDataOffset() == RE::LocalizedStringTable::headerSize + 3 * sizeof(RE::LocalizedStringTable::DirectoryEntry));
+
+			const auto strings = read_all(table);
+			Test::Check(strings.size() == 3);
+			Test::Check(strings[0].stringID == 1 && strings[0].string == "Hello");
+			Test::Check(strings[1].stringID == 7 && strings[1].string.empty());
+			Test::Check(strings[2].stringID == 0xFFFFFFFF && strings[2].string == "Привет");
+		}
+	}
+
+	void test_empty_table()
+	{
+		const auto                     buffer = StringTableBuilder(Type::kILStrings).Build();
+		const RE::LocalizedStringTable table(buffer, Type::kILStrings);
+		Test::Check(table.IsValid());
+		Test::Check(table.GetEntryCount() == 0);
+		Test::Check(read_all(table).empty());
+	}
+
+	void test_truncated_header()
+	{
+		const auto buffer = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Build();
+
+		for (std::size_t size = 0; size < RE::LocalizedStringTable::headerSize; ++size) {
+			const auto header = std::span(buffer).first(size);
+
+			const RE::LocalizedStringTable table(header, Type::kILStrings);
+			Test::Check(!table.IsValid());
+			Test::Check(table.GetEntryCount() == 0);
+			Test::Check(RE::LocalizedStringTable::GetDirectoryEnd(header).has_value() == (size >= 4));  // only the count is needed
+		}
+	}
+
+	void test_directory_past_end()
+	{
+		const auto buffer = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "World").Build(3);
+
+		const RE::LocalizedStringTable table(buffer, Type::kILStrings);
+		Test::Check(!table.IsValid());
+		Test::Check(table.GetEntryCount() == 0);
+		Test::Check(read_all(table).empty());
+
+		// a count whose directory size does not fit 32 bits
+		const auto huge = StringTableBuilder(Type::kILStrings).Build(0xFFFFFFFF);
+		Test::Check(!RE::LocalizedStringTable(huge, Type::kILStrings).IsValid());
+		Test::Check(!RE::LocalizedStringTable::GetDirectoryEnd(huge));
+	}
+
+	void test_data_past_end()
+	{
+		const auto builder = StringTableBuilder(Type::kILStrings).Add(1, "Hello");
+		const auto buffer = builder.Build(std::nullopt, 1000);
+
+		Test::Check(!RE::LocalizedStringTable(buffer, Type::kILStrings).IsValid());
+
+		// only the directory is read up front when the strings are loaded on demand
+		const auto                     header = std::span(buffer).first(*RE::LocalizedStringTable::GetDirectoryEnd(buffer));
+		const RE::LocalizedStringTable directory(header, Type::kILStrings, true);
+		Test::Check(directory.IsValid());
+		Test::Check(directory.GetEntryCount() == 1);
+		Test::Check(directory.GetEntry(0).stringID == 1);
+		Test::Check(directory.GetStringAtOffset(directory.GetEntry(0).offset).empty());
+	}
+
+	void test_offset_past_end()
+	{
+		for (const auto type : { Type::kStrings, Type::kILStrings }) {
+			const auto buffer = StringTableBuilder(type).Add(1, "Hello").AddRaw(2, 6).AddRaw(3, 1000).AddRaw(4, 0xFFFFFFFE).Build();
+
+			const RE::LocalizedStringTable table(buffer, type);
+			Test::Check(table.IsValid());
+
+			const auto strings = read_all(table);
+			Test::Check(strings.size() == 4);
+			Test::Check(strings[0].string == "Hello");
+			for (std::size_t i = 2; i < strings.size(); ++i) {
+				Test::Check(strings[i].string.empty());
+			}
+		}
+	}
+
+	void test_length_past_end()
+	{
+		// prefix claims more bytes than the data block holds
+		constexpr std::array<std::byte, 7> bytes{ std::byte{ 0xFF }, std::byte{ 0 }, std::byte{ 0 }, std::byte{ 0 }, std::byte{ 'a' }, std::byte{ 'b' }, std::byte{ 0 } };
+		const auto                         buffer = StringTableBuilder(Type::kILStrings).AddRaw(1, 0).AddRaw(2, 5).AppendData(bytes).Build();
+
+		const RE::LocalizedStringTable table(buffer, Type::kILStrings);
+		Test::Check(table.IsValid());
+		Test::Check(table.GetStringAtOffset(0).empty());
+		Test::Check(table.GetStringAtOffset(5).empty());  // not even room for the prefix
+		Test::Check(table.GetStringAtOffset(static_cast<std::uint32_t>(bytes.size())).empty());
+	}
+
+	void test_missing_terminator()
+	{
+		constexpr std::array<std::byte, 3> bytes{ std::byte{ 'a' }, std::byte{ 'b' }, std::byte{ 'c' } };
+		const auto                         buffer = StringTableBuilder(Type::kStrings).AddRaw(1, 0).AddRaw(2, 2).AppendData(bytes).Build();
+
+		const RE::LocalizedStringTable table(buffer, Type::kStrings);
+		Test::Check(table.IsValid());
+		Test::Check(table.GetStringAtOffset(0).empty());
+		Test::Check(table.GetStringAtOffset(2).empty());
+	}
+
+	void test_strings_stay_in_buffer()
+	{
+		// trailing bytes past dataSize belong to nobody, a string must not run into them
+		const auto builder = StringTableBuilder(Type::kStrings).AddRaw(1, 0);
+		auto       buffer = builder.Build(std::nullopt, 3);
+		for (const auto ch : "abc\0def"sv) {
+			buffer.push_back(static_cast<std::byte>(ch));
+		}
+
+		const RE::LocalizedStringTable table(buffer, Type::kStrings);
+		Test::Check(table.IsValid());
+		Test::Check(table.GetStringAtOffset(0).empty());
+	}
+
+	void test_parse()
+	{
+		const auto buffer = StringTableBuilder(Type::kILStrings).Add(1, "Hello").Add(2, "").Add(3, " \t\r\n").Add(0xFFFFFFFF, "Привет").Build();
+
+		// ids carry the mod index, blank strings are left out
+		const auto entries = StringTableParser::Parse(buffer, Type::kILStrings, 0x102);
+		Test::Check(entries && entries->size() == 2);
+		Test::Check((*entries)[0].id == 0x102'00000001 && (*entries)[0].subtitle == "Hello");
+		Test::Check((*entries)[1].id == 0x102'FFFFFFFF && (*entries)[1].subtitle == "Привет");
+
+		// the entries view the table, nothing is copied
+		const auto* data = reinterpret_cast<const char*>(buffer.data());
+		for (const auto& [id, subtitle] : *entries) {
+			Test::Check(subtitle.data() >= data && subtitle.data() + subtitle.size() <= data + buffer.size());
+		}
+
+		Test::Check(!StringTableParser::Parse(std::span(buffer).first(4), Type::kILStrings, 0));
+	}
+}
+
+int main()
+{
+	test_well_formed();
+	test_empty_table();
+	test_truncated_header();
+	test_directory_past_end();
+	test_data_past_end();
+	test_offset_past_end();
+	test_length_past_end();
+	test_missing_terminator();
+	test_strings_stay_in_buffer();
+	test_parse();
+
+	return Test::Result();
+}
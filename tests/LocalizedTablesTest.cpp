@@ -0,0 +1,167 @@
+#include "LocalizedTables.h"
+
+namespace
+{
+	using Table = LocalizedTables::Table;
+	using SubtitleID = LocalizedTables::SubtitleID;
+
+	constexpr auto invalidRow = SubtitleTable::invalidRow;
+
+	// English is the game language, plugin 1 and plugin 2 share a line
+	void build(LocalizedTables& a_tables)
+	{
+		const std::vector<Table> partials{
+			{ {}, { { 0x1'00000001, "Hello" }, { 0x1'00000002, "Goodbye" } } },
+			{ {}, { { 0x1'00000001, "Hallo" }, { 0x1'00000002, "Tschüss" } } },
+			{ {}, { { 0x2'00000005, "Hello" } } },
+			{ {}, { { 0x2'00000005, "Servus" } } }
+		};
+		const std::array languages{ Language::kEnglish, Language::kGerman, Language::kEnglish, Language::kGerman };
+
+		a_tables.Build(partials, languages, Language::kEnglish);
+	}
+
+	std::string_view find(const LocalizedTables& a_tables, std::string_view a_english, Language a_language)
+	{
+		const auto row = a_tables.subtitleTable.FindRow(a_english);
+		return row != invalidRow ? a_tables.subtitleTable.GetString(row, a_language) : std::string_view{};
+	}
+
+	void test_build()
+	{
+		LocalizedTables tables;
+		build(tables);
+
+		Test::Check(tables.subtitleTable.GetIndexedCount() == 2);
+		Test::Check(find(tables, "Goodbye", Language::kGerman) == "Tschüss");
+
+		// the shared line is indexed once, the other plugin's row is kept as an alternate
+		const auto row = tables.subtitleTable.FindRow("Hello"sv);
+		Test::Check(row != invalidRow);
+		Test::Check(tables.alternateRows.size() == 1 && tables.alternateRows.contains(row));
+
+		const auto& alternates = tables.alternateRows.at(row);
+		Test::Check(alternates.size() == 1);
+
+		std::set<std::string_view> translations{ tables.subtitleTable.GetString(row, Language::kGerman), tables.subtitleTable.GetString(alternates[0], Language::kGerman) };
+		Test::Check(translations == std::set<std::string_view>{ "Hallo", "Servus" });
+	}
+
+	void test_add_translations()
+	{
+		LocalizedTables tables;
+		build(tables);
+
+		const std::vector<Table> partials{
+			{ {}, { { 0x1'00000001, "Bonjour" }, { 0x1'00000009, "Jamais vu" } } }
+		};
+		const std::array languages{ Language::kFrench };
+
+		tables.AddTranslations(LocalizedTables::GetTranslations(partials, languages));
+
+		Test::Check(tables.subtitleTable.GetString(tables.subtitleTable.FindRow(SubtitleID{ 0x1'00000001 }), Language::kFrench) == "Bonjour");
+		Test::Check(tables.subtitleTable.FindRow(SubtitleID{ 0x1'00000009 }) == invalidRow);  // no row to add it to
+		Test::Check(find(tables, "Goodbye", Language::kFrench).empty());
+	}
+
+	// an id with several strings in one language shows the same one whether the language is built with the game
+	// language or added later
+	void test_same_pick_both_ways()
+	{
+		constexpr std::uint32_t ids = 20;
+		constexpr std::uint32_t stringsPerID = 5;
+
+		// English once per id, German spread over several files of the same plugin
+		std::deque<std::string> strings;
+		std::vector<Table>      partials(1 + stringsPerID);
+		std::vector<Language>   languages{ Language::kEnglish };
+		for (std::uint32_t i = 0; i < ids; ++i) {
+			partials[0].entries.push_back({ SubtitleID{ 0x1'00000000 } + i, strings.emplace_back("Line " + std::to_string(i)) });
+		}
+		for (std::uint32_t file = 1; file <= stringsPerID; ++file) {
+			languages.push_back(Language::kGerman);
+			for (std::uint32_t i = 0; i < ids; ++i) {
+				partials[file].entries.push_back({ SubtitleID{ 0x1'00000000 } + i, strings.emplace_back("Zeile " + std::to_string(i) + " aus " + std::to_string(file)) });
+			}
+		}
+
+		LocalizedTables together;
+		together.Build(partials, languages, Language::kEnglish);
+
+		LocalizedTables later;
+		later.Build(std::span(partials).first(1), std::span(languages).first(1), Language::kEnglish);
+		later.AddTranslations(LocalizedTables::GetTranslations(std::span(partials).subspan(1), std::span(languages).subspan(1)));
+
+		Test::Check(together.subtitleTable.GetRowCount() == ids && later.subtitleTable.GetRowCount() == ids);
+		for (std::uint32_t i = 0; i < ids; ++i) {
+			const auto english = "Line " + std::to_string(i);
+			Test::Check(!find(together, english, Language::kGerman).empty());
+			Test::Check(find(together, english, Language::kGerman) == find(later, english, Language::kGerman));
+		}
+	}
+
+	// a translation that is not UTF-8 is left out both ways, a game language line is kept whatever its encoding
+	void test_invalid_utf8()
+	{
+		const std::vector<Table> partials{
+			{ {}, { { 0x1'00000001, "Caf\xE9" }, { 0x1'00000002, "Goodbye" } } },
+			{ {}, { { 0x1'00000001, "Kaffee" }, { 0x1'00000002, "Tsch\xFCss" } } }
+		};
+		const std::array languages{ Language::kEnglish, Language::kGerman };
+
+		LocalizedTables tables;
+		tables.Build(partials, languages, Language::kEnglish);
+		Test::Check(tables.subtitleTable.GetIndexedCount() == 2);
+		Test::Check(find(tables, "Caf\xE9", Language::kGerman) == "Kaffee");
+		Test::Check(find(tables, "Goodbye", Language::kGerman).empty());
+
+		const auto translations = LocalizedTables::GetTranslations(std::span(partials).subspan(1), std::span(languages).subspan(1));
+		Test::Check(translations.contains(0x1'00000001) && !translations.contains(0x1'00000002));
+	}
+
+	void test_round_trip()
+	{
+		LocalizedTables tables;
+		build(tables);
+
+		std::ostringstream stream;
+		tables.Write(stream);
+		const auto data = std::move(stream).str();
+		const auto bytes = std::as_bytes(std::span(data));
+
+		LocalizedTables loaded;
+		Test::Check(loaded.Read(bytes));
+		Test::Check(loaded.subtitleTable.GetRowCount() == tables.subtitleTable.GetRowCount());
+		Test::Check(loaded.subtitleTable.GetIndexedCount() == tables.subtitleTable.GetIndexedCount());
+		Test::Check(loaded.alternateRows == tables.alternateRows);
+		for (SubtitleTable::Row row = 0; row < tables.subtitleTable.GetRowCount(); ++row) {
+			Test::Check(loaded.subtitleTable.GetID(row) == tables.subtitleTable.GetID(row));
+			for (std::size_t language = 0; language < std::to_underlying(Language::kTotal); ++language) {
+				Test::Check(loaded.subtitleTable.GetString(row, static_cast<Language>(language)) == tables.subtitleTable.GetString(row, static_cast<Language>(language)));
+			}
+		}
+		Test::Check(find(loaded, "Goodbye", Language::kGerman) == "Tschüss");
+
+		// every cut short copy is rejected and leaves the tables as they were
+		for (std::size_t size = 0; size < bytes.size(); ++size) {
+			Test::Check(!loaded.Read(bytes.first(size)));
+		}
+		Test::Check(find(loaded, "Goodbye", Language::kGerman) == "Tschüss");
+
+		// an index language that isn't one
+		auto corrupt = data;
+		std::memset(corrupt.data(), 0xFF, sizeof(Language));
+		Test::Check(!LocalizedTables{}.Read(std::as_bytes(std::span(corrupt))));
+	}
+}
+
+int main()
+{
+	test_build();
+	test_add_translations();
+	test_same_pick_both_ways();
+	test_invalid_utf8();
+	test_round_trip();
+
+	return Test::Result();
+}
@@ -0,0 +1,100 @@
+#include "MPSCQueue.h"
+
+namespace
+{
+	struct Item
+	{
+		std::uint32_t producer;
+		std::uint32_t sequence;
+	};
+
+	void test_order()
+	{
+		MPSCQueue<std::uint32_t> queue;
+		for (std::uint32_t i = 0; i < 5; ++i) {
+			queue.Push(i);
+		}
+
+		std::vector<std::uint32_t> values;
+		Test::Check(queue.Consume([&](std::uint32_t a_value) { values.push_back(a_value); }) == 5);
+		Test::Check(values == std::vector<std::uint32_t>{ 0, 1, 2, 3, 4 });
+		Test::Check(queue.Consume([](std::uint32_t) {}) == 0);
+	}
+
+	// a stop request wakes a consumer waiting on an empty queue
+	void test_stop()
+	{
+		MPSCQueue<std::uint32_t> queue;
+		std::atomic_bool         woken{ false };
+
+		std::jthread consumer([&](std::stop_token a_token) {
+			queue.Wait(a_token);
+			woken = true;
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		Test::Check(!woken);
+
+		consumer.request_stop();
+		consumer.join();
+		Test::Check(woken);
+	}
+
+	// nothing is lost or seen twice, and each producer's items arrive in the order it pushed them
+	void test_stress()
+	{
+		const auto producerCount = std::max(std::thread::hardware_concurrency(), 4u) - 1;
+		constexpr std::uint32_t pushes = 100000;
+
+		MPSCQueue<Item>            queue;
+		std::vector<std::uint32_t> next(producerCount, 0);
+		std::atomic<std::uint32_t> received{ 0 };
+		std::atomic<std::uint32_t> failures{ 0 };
+
+		std::jthread consumer([&](std::stop_token a_token) {
+			while (true) {
+				queue.Wait(a_token);
+				if (a_token.stop_requested()) {
+					return;
+				}
+				received += static_cast<std::uint32_t>(queue.Consume([&](Item&& a_item) {
+					// a duplicate or a reordered item breaks the sequence
+					if (a_item.producer >= producerCount || a_item.sequence != next[a_item.producer]++) {
+						++failures;
+					}
+				}));
+			}
+		});
+
+		{
+			std::vector<std::jthread> producers;
+			for (std::uint32_t i = 0; i < producerCount; ++i) {
+				producers.emplace_back([&queue, i]() {
+					for (std::uint32_t sequence = 0; sequence < pushes; ++sequence) {
+						queue.Push({ i, sequence });
+					}
+				});
+			}
+		}
+
+		// wait for the consumer to catch up before stopping it, whatever it hasn't taken would be dropped
+		while (received < producerCount * pushes && failures == 0) {
+			std::this_thread::yield();
+		}
+		consumer.request_stop();
+		consumer.join();
+
+		Test::Check(failures == 0);
+		Test::Check(received == producerCount * pushes);
+		Test::Check(std::ranges::all_of(next, [](auto a_count) { return a_count == pushes; }));
+	}
+}
+
+int main()
+{
+	test_order();
+	test_stop();
+	test_stress();
+
+	return Test::Result();
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+// Stands in for include/PCH.h, the code under test only needs the standard library, the flat containers and a few
+// game types it never looks into.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <set>
+#include <shared_mutex>
+#include <source_location>
+#include <span>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __has_include(<boost_unordered.hpp>)
+#	include <boost_unordered.hpp>
+
+template <class K, class D, class H = boost::hash<K>, class KEqual = std::equal_to<K>>
+using FlatMap = boost::unordered_flat_map<K, D, H, KEqual>;
+
+template <class K, class H = boost::hash<K>, class KEqual = std::equal_to<K>>
+using FlatSet = boost::unordered_flat_set<K, H, KEqual>;
+#else
+// without vcpkg, same interface as far as the tested code goes
+#	include <unordered_map>
+#	include <unordered_set>
+
+template <class K, class D, class H = std::hash<K>, class KEqual = std::equal_to<K>>
+using FlatMap = std::unordered_map<K, D, H, KEqual>;
+
+template <class K, class H = std::hash<K>, class KEqual = std::equal_to<K>>
+using FlatSet = std::unordered_set<K, H, KEqual>;
+
+namespace boost::unordered
+{
+	using std::erase_if;
+}
+#endif
+
+using namespace std::literals;
+
+// the ClibUtil helpers the tested code uses
+namespace string
+{
+	inline bool is_only_space(std::string_view a_str)
+	{
+		return std::ranges::all_of(a_str, [](char a_char) { return std::isspace(static_cast<unsigned char>(a_char)) != 0; });
+	}
+
+	constexpr std::uint32_t const_hash(std::string_view a_str)
+	{
+		std::uint32_t hash = 2166136261u;
+		for (const auto ch : a_str) {
+			hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+		}
+		return hash;
+	}
+
+	inline namespace literals
+	{
+		constexpr std::uint32_t operator""_h(const char* a_str, std::size_t a_len) { return const_hash({ a_str, a_len }); }
+	}
+}
+
+using namespace string::literals;
+
+// log lines go nowhere
+namespace logger
+{
+	template <class... Args>
+	void info(Args&&...)
+	{}
+
+	template <class... Args>
+	void warn(Args&&...)
+	{}
+
+	template <class... Args>
+	void error(Args&&...)
+	{}
+}
+
+// game types the tested code only passes around, tests that need them define them
+namespace RE
+{
+	struct Actor;
+	struct hknpBSWorld;
+
+	// what the visibility cache keys and measures speakers by
+	class ObjectRefHandle
+	{
+	public:
+		ObjectRefHandle() = default;
+		explicit ObjectRefHandle(std::uint32_t a_handle) :
+			handle(a_handle)
+		{}
+
+		std::uint32_t native_handle() const { return handle; }
+
+	private:
+		// members
+		std::uint32_t handle{ 0 };
+	};
+
+	struct NiPoint3
+	{
+		float x{ 0.0f };
+		float y{ 0.0f };
+		float z{ 0.0f };
+
+		NiPoint3 operator-(const NiPoint3& a_rhs) const { return { x - a_rhs.x, y - a_rhs.y, z - a_rhs.z }; }
+	};
+}
+
+#include "Test.h"
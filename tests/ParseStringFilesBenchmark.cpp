@@ -0,0 +1,123 @@
+#include "StringTableBuilder.h"
+#include "StringTableParser.h"
+
+#include <benchmark/benchmark.h>
+
+// Single table parse throughput for each of the three formats, then ParseStringFiles from 1 to N cores. Each (plugin, language) table is one task, as on the worker pool.
+// The tables are generated in memory, so this measures parsing into entries that view the table, not the game's file
+// streams. The base game table is most of the text, the time never drops below parsing it alone.
+namespace
+{
+	using Type = RE::LocalizedStringTable::Type;
+	using Entries = std::vector<StringTableParser::Entry>;
+
+	struct Table
+	{
+		std::vector<std::byte> buffer;
+		std::uint32_t          modIndex;
+	};
+
+	// the base game, its six DLC and a load order of small mods, in two languages
+	const std::vector<Table>& get_tables()
+	{
+		static const auto tables = [] {
+			std::vector<std::uint32_t> entryCounts{ 40000, 6000, 4000, 3000, 2000, 2000, 1500 };
+			for (std::uint32_t i = 0; i < 60; ++i) {
+				entryCounts.push_back(50 + (i * 137) % 800);
+			}
+
+			std::vector<Table> result;
+			for (std::uint32_t language = 0; language < 2; ++language) {
+				for (std::uint32_t i = 0; i < entryCounts.size(); ++i) {
+					result.emplace_back(StringTableBuilder::Generate(Type::kILStrings, entryCounts[i], i * 2 + language), i);
+				}
+			}
+			return result;
+		}();
+		return tables;
+	}
+
+	std::int64_t get_total_size()
+	{
+		std::int64_t size = 0;
+		for (const auto& table : get_tables()) {
+			size += static_cast<std::int64_t>(table.buffer.size());
+		}
+		return size;
+	}
+
+	Entries parse(const Table& a_table)
+	{
+		return StringTableParser::Parse(a_table.buffer, Type::kILStrings, a_table.modIndex).value_or(Entries{});
+	}
+
+	// one base game sized table, .STRINGS are null-terminated, the other two length-prefixed
+	void BM_Parse(benchmark::State& a_state)
+	{
+		const auto type = static_cast<Type>(a_state.range(0));
+		const auto buffer = StringTableBuilder::Generate(type, 40000, 0);
+
+		for (auto _ : a_state) {
+			auto entries = StringTableParser::Parse(buffer, type, 0);
+			benchmark::DoNotOptimize(entries);
+		}
+
+		a_state.SetBytesProcessed(a_state.iterations() * static_cast<std::int64_t>(buffer.size()));
+		a_state.SetLabel(std::string(RE::LocalizedStringTable::GetExtension(type)));
+	}
+
+	// tables handed out in order to a_state.range(0) threads, the way pool workers take tasks
+	void BM_ParseStringFiles(benchmark::State& a_state)
+	{
+		const auto& tables = get_tables();
+		const auto  threadCount = static_cast<std::size_t>(a_state.range(0));
+
+		for (auto _ : a_state) {
+			std::vector<Entries>     partials(tables.size());
+			std::atomic<std::size_t> next{ 0 };
+			{
+				std::vector<std::jthread> threads;
+				for (std::size_t i = 0; i < threadCount; ++i) {
+					threads.emplace_back([&]() {
+						for (auto j = next++; j < tables.size(); j = next++) {
+							partials[j] = parse(tables[j]);
+						}
+					});
+				}
+			}
+			benchmark::DoNotOptimize(partials.data());
+		}
+
+		a_state.SetBytesProcessed(a_state.iterations() * get_total_size());
+		a_state.counters["tables"] = static_cast<double>(tables.size());
+	}
+
+	// what ParseStringFiles itself runs, on however many cores the parallel algorithms get
+	void BM_ParseStringFilesPar(benchmark::State& a_state)
+	{
+		const auto& tables = get_tables();
+
+		for (auto _ : a_state) {
+			std::vector<Entries> partials(tables.size());
+			std::transform(std::execution::par, tables.begin(), tables.end(), partials.begin(), parse);
+			benchmark::DoNotOptimize(partials.data());
+		}
+
+		a_state.SetBytesProcessed(a_state.iterations() * get_total_size());
+	}
+
+	void thread_counts(benchmark::internal::Benchmark* a_benchmark)
+	{
+		const auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+		for (std::uint32_t threads = 1; threads < cores; threads *= 2) {
+			a_benchmark->Arg(threads);
+		}
+		a_benchmark->Arg(cores);
+	}
+}
+
+BENCHMARK(BM_Parse)->DenseRange(0, std::to_underlying(Type::kTotal) - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseStringFiles)->Apply(thread_counts)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseStringFilesPar)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,116 @@
+#include "RayBatch.h"
+
+#include <benchmark/benchmark.h>
+
+// stand-ins, a batch only hands them back to its world
+namespace RE
+{
+	struct hknpBSWorld
+	{};
+
+	struct Actor
+	{
+		hknpBSWorld*  world;
+		std::uint32_t visiblePoints;  // bit per LOS point
+	};
+}
+
+// One update of RaycastScheduler for crowds of 1 to 500 speakers, against a mock pick. Each iteration is a frame:
+// speakers are queued oldest first the way the scheduler ranks them, one ray for those that were obscured, four for
+// the rest, and cast with the default budget of 12 rays or with no budget. The pick only looks up the actor's mask,
+// so the times are the batch's own overhead, a real hknp cast adds a few microseconds per ray on top.
+namespace
+{
+	class MockWorld : public RayBatch::World
+	{
+	public:
+		RE::hknpBSWorld* GetPhysicsWorld(RE::Actor* a_actor) override
+		{
+			return a_actor->world;
+		}
+
+		void BeginPicks(RE::hknpBSWorld* a_world) override
+		{
+			benchmark::DoNotOptimize(a_world);
+		}
+
+		bool Pick(RE::Actor* a_actor, std::uint32_t a_point) override
+		{
+			return a_actor->visiblePoints & (1u << a_point);
+		}
+	};
+
+	struct Speaker
+	{
+		RE::Actor     actor;
+		std::uint32_t nextPoint{ 0 };
+		bool          obscured{ false };
+	};
+
+	// an interior and the worldspace around it, a quarter of the crowd fully hidden
+	std::vector<Speaker> get_crowd(std::size_t a_size, std::array<RE::hknpBSWorld, 2>& a_worlds)
+	{
+		std::mt19937         rng(static_cast<std::uint32_t>(a_size));
+		std::vector<Speaker> crowd(a_size);
+		for (auto& speaker : crowd) {
+			speaker.actor.world = &a_worlds[rng() % a_worlds.size()];
+			speaker.actor.visiblePoints = rng() % 4 == 0 ? 0 : rng() % 16;
+		}
+		return crowd;
+	}
+
+	void BM_CastCrowd(benchmark::State& a_state)
+	{
+		const auto size = static_cast<std::size_t>(a_state.range(0));
+		const auto rayBudget = a_state.range(1) ? static_cast<std::uint32_t>(a_state.range(1)) : std::numeric_limits<std::uint32_t>::max();
+
+		std::array<RE::hknpBSWorld, 2> worlds;
+		auto                           crowd = get_crowd(size, worlds);
+
+		MockWorld     world;
+		RayBatch      batch;
+		std::size_t   first = 0;  // oldest speaker, deferred ones are ranked first next frame
+		std::uint64_t rays = 0;
+		std::uint64_t checked = 0;
+
+		for (auto _ : a_state) {
+			for (std::size_t i = 0; i < size; ++i) {
+				auto& speaker = crowd[(first + i) % size];
+				batch.Add(&speaker.actor, speaker.nextPoint, speaker.obscured ? 1 : 4);
+			}
+
+			batch.Cast(world, rayBudget);
+
+			const auto queries = batch.GetQueries();
+			std::size_t done = 0;
+			for (std::size_t i = 0; i < size && queries[i].done; ++i, ++done) {
+				auto& speaker = crowd[(first + i) % size];
+				speaker.nextPoint = queries[i].nextPoint;
+				speaker.obscured = queries[i].result == RayBatch::Result::kObscured;
+			}
+			first = (first + done) % size;
+
+			rays += batch.GetRayCount();
+			checked += done;
+			batch.Clear();
+		}
+
+		a_state.counters["rays/s"] = benchmark::Counter(static_cast<double>(rays), benchmark::Counter::kIsRate);
+		a_state.counters["checked/frame"] = static_cast<double>(checked) / static_cast<double>(a_state.iterations());
+		a_state.counters["framesToCheckAll"] = checked ? static_cast<double>(size) * static_cast<double>(a_state.iterations()) / static_cast<double>(checked) : 0.0;
+	}
+
+	void crowd_sizes(benchmark::internal::Benchmark* a_benchmark)
+	{
+		a_benchmark->ArgNames({ "crowd", "budget" });
+		for (const std::int64_t budget : { 12, 0 }) {
+			for (const std::int64_t size : { 1, 10, 50, 100, 250, 500 }) {
+				a_benchmark->Args({ size, budget });
+			}
+		}
+	}
+}
+
+BENCHMARK(BM_CastCrowd)->Apply(crowd_sizes)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
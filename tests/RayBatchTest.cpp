@@ -0,0 +1,246 @@
+#include "RayBatch.h"
+
+// stand-ins, a batch only hands them back to its world
+namespace RE
+{
+	struct hknpBSWorld
+	{};
+
+	struct Actor
+	{
+		hknpBSWorld*  world;          // null when not attached
+		std::uint32_t visiblePoints;  // bit per LOS point
+	};
+}
+
+namespace
+{
+	using Result = RayBatch::Result;
+
+	class FakeWorld : public RayBatch::World
+	{
+	public:
+		struct PickRecord
+		{
+			const RE::Actor*       actor;
+			const RE::hknpBSWorld* world;
+			std::uint32_t          point;
+		};
+
+		RE::hknpBSWorld* GetPhysicsWorld(RE::Actor* a_actor) override
+		{
+			return a_actor->world;
+		}
+
+		void BeginPicks(RE::hknpBSWorld* a_world) override
+		{
+			current = a_world;
+			++worldSwitches;
+		}
+
+		bool Pick(RE::Actor* a_actor, std::uint32_t a_point) override
+		{
+			picks.push_back({ a_actor, current, a_point });
+			return a_actor->visiblePoints & (1u << a_point);
+		}
+
+		// members
+		std::vector<PickRecord> picks;
+		const RE::hknpBSWorld*  current{ nullptr };
+		std::uint32_t           worldSwitches{ 0 };
+	};
+
+	RE::hknpBSWorld worldA;
+	RE::hknpBSWorld worldB;
+
+	void test_single()
+	{
+		RE::Actor visible{ &worldA, 0b0001 };
+		RE::Actor feet{ &worldA, 0b1000 };
+		RE::Actor hidden{ &worldA, 0 };
+		RE::Actor detached{ nullptr, 0b1111 };
+
+		FakeWorld world;
+		RayBatch  batch;
+		batch.Add(&visible, 0, 4);
+		batch.Add(&feet, 2, 4);
+		batch.Add(&hidden, 1, 4);
+		batch.Add(&detached, 0, 4);
+		batch.Cast(world, 100);
+
+		const auto queries = batch.GetQueries();
+		Test::Check(std::ranges::all_of(queries, &RayBatch::Query::done));
+
+		// stops at the first point that reaches the actor
+		Test::Check(queries[0].result == Result::kVisible && queries[0].rayCount == 1 && queries[0].nextPoint == 0);
+		// torso, then feet
+		Test::Check(queries[1].result == Result::kVisible && queries[1].rayCount == 2 && queries[1].nextPoint == 3);
+		// all four, the next check starts where this one did
+		Test::Check(queries[2].result == Result::kObscured && queries[2].rayCount == 4 && queries[2].nextPoint == 1);
+		// no world, no rays
+		Test::Check(queries[3].result == Result::kOffscreen && queries[3].rayCount == 0);
+
+		Test::Check(batch.GetRayCount() == 7 && world.picks.size() == 7);
+
+		// the points wrap around from the first one
+		std::vector<std::uint32_t> points;
+		for (const auto& pick : world.picks) {
+			if (pick.actor == &hidden) {
+				points.push_back(pick.point);
+			}
+		}
+		Test::Check(points == std::vector<std::uint32_t>{ 1, 2, 3, 0 });
+	}
+
+	void test_max_rays()
+	{
+		RE::Actor hidden{ &worldA, 0 };
+		RE::Actor head{ &worldA, 0b0010 };
+
+		FakeWorld world;
+		RayBatch  batch;
+		batch.Add(&hidden, 3, 1);
+		batch.Add(&head, 0, 1);   // the head is never tried
+		batch.Add(&hidden, 0, 9);  // clamped to the four points
+		batch.Cast(world, 100);
+
+		const auto queries = batch.GetQueries();
+		Test::Check(queries[0].result == Result::kObscured && queries[0].rayCount == 1 && queries[0].nextPoint == 0);
+		Test::Check(queries[1].result == Result::kObscured && queries[1].rayCount == 1 && queries[1].nextPoint == 1);
+		Test::Check(queries[2].maxRays == 4 && queries[2].rayCount == 4);
+	}
+
+	void test_budget()
+	{
+		RE::Actor eye{ &worldA, 0b0001 };
+		RE::Actor hidden{ &worldA, 0 };
+
+		// the first query finishes even when it is over budget, nothing after it starts
+		{
+			FakeWorld world;
+			RayBatch  batch;
+			batch.Add(&hidden, 0, 4);
+			batch.Add(&eye, 0, 1);
+			batch.Cast(world, 2);
+
+			const auto queries = batch.GetQueries();
+			Test::Check(queries[0].done && queries[0].rayCount == 4);
+			Test::Check(!queries[1].done && queries[1].rayCount == 0);
+			Test::Check(batch.GetRayCount() == 4);
+		}
+
+		// rays the first query did not need go to the next one, which then fits
+		{
+			FakeWorld world;
+			RayBatch  batch;
+			batch.Add(&eye, 0, 4);
+			batch.Add(&hidden, 0, 4);
+			batch.Add(&hidden, 0, 4);
+			batch.Cast(world, 5);
+
+			const auto queries = batch.GetQueries();
+			Test::Check(queries[0].done && queries[0].rayCount == 1);
+			Test::Check(queries[1].done && queries[1].rayCount == 4);
+			Test::Check(!queries[2].done && queries[2].rayCount == 0);
+			Test::Check(batch.GetRayCount() == 5);
+		}
+
+		// an offscreen query costs nothing and never holds the others back
+		{
+			RE::Actor detached{ nullptr, 0 };
+
+			FakeWorld world;
+			RayBatch  batch;
+			batch.Add(&detached, 0, 4);
+			batch.Add(&hidden, 0, 4);
+			batch.Add(&detached, 0, 4);
+			batch.Cast(world, 4);
+
+			const auto queries = batch.GetQueries();
+			Test::Check(std::ranges::all_of(queries, &RayBatch::Query::done));
+			Test::Check(queries[0].result == Result::kOffscreen && queries[2].result == Result::kOffscreen);
+			Test::Check(batch.GetRayCount() == 4);
+		}
+
+		// the first query to cast is the one that always finishes, whether or not an offscreen one came before it
+		{
+			RE::Actor detached{ nullptr, 0 };
+
+			FakeWorld world;
+			RayBatch  batch;
+			batch.Add(&detached, 0, 4);
+			batch.Add(&hidden, 0, 4);
+			batch.Add(&eye, 0, 1);
+			batch.Cast(world, 1);
+
+			const auto queries = batch.GetQueries();
+			Test::Check(queries[0].done && queries[0].result == Result::kOffscreen);
+			Test::Check(queries[1].done && queries[1].rayCount == 4);
+			Test::Check(!queries[2].done && queries[2].rayCount == 0);
+			Test::Check(batch.GetRayCount() == 4);
+		}
+
+		// cleared, the next batch gets the whole budget again
+		{
+			FakeWorld world;
+			RayBatch  batch;
+			batch.Add(&hidden, 0, 4);
+			batch.Cast(world, 4);
+			batch.Clear();
+			Test::Check(batch.GetQueries().empty() && batch.GetRayCount() == 0);
+
+			batch.Add(&hidden, 0, 4);
+			batch.Add(&hidden, 0, 4);
+			batch.Cast(world, 8);
+			Test::Check(std::ranges::all_of(batch.GetQueries(), &RayBatch::Query::done));
+		}
+	}
+
+	void test_grouping()
+	{
+		RE::Actor a1{ &worldA, 0 };
+		RE::Actor b1{ &worldB, 0b0100 };
+		RE::Actor a2{ &worldA, 0b0001 };
+		RE::Actor b2{ &worldB, 0 };
+
+		FakeWorld world;
+		RayBatch  batch;
+		batch.Add(&a1, 0, 4);
+		batch.Add(&b1, 0, 4);
+		batch.Add(&a2, 0, 4);
+		batch.Add(&b2, 0, 4);
+		batch.Cast(world, 100);
+
+		// every pick is made in the actor's own world, one switch per world
+		Test::Check(std::ranges::all_of(world.picks, [](const FakeWorld::PickRecord& a_pick) { return a_pick.world == a_pick.actor->world; }));
+		Test::Check(world.worldSwitches == 2);
+
+		// each world's queries keep the order they were added in
+		std::vector<const RE::Actor*> order;
+		for (const auto& pick : world.picks) {
+			if (order.empty() || order.back() != pick.actor) {
+				order.push_back(pick.actor);
+			}
+		}
+		const auto position = [&](const RE::Actor* a_actor) { return std::ranges::find(order, a_actor) - order.begin(); };
+		Test::Check(order.size() == 4);
+		Test::Check(position(&a1) < position(&a2) && position(&b1) < position(&b2));
+
+		// results land on the query they belong to
+		const auto queries = batch.GetQueries();
+		Test::Check(queries[0].result == Result::kObscured && queries[0].rayCount == 4);
+		Test::Check(queries[1].result == Result::kVisible && queries[1].nextPoint == 2);
+		Test::Check(queries[2].result == Result::kVisible && queries[2].nextPoint == 0);
+		Test::Check(queries[3].result == Result::kObscured && queries[3].rayCount == 4);
+	}
+}
+
+int main()
+{
+	test_single();
+	test_max_rays();
+	test_budget();
+	test_grouping();
+
+	return Test::Result();
+}
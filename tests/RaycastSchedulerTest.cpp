@@ -0,0 +1,154 @@
+#include "RaycastScheduler.h"
+
+// stand-ins, a batch only hands them back to its world
+namespace RE
+{
+	struct hknpBSWorld
+	{};
+
+	struct Actor
+	{
+		std::uint32_t visiblePoints;  // bit per LOS point
+	};
+}
+
+namespace
+{
+	using Clock = VisibilityCache::Clock;
+	using Result = RayBatch::Result;
+
+	class FakeWorld : public RayBatch::World
+	{
+	public:
+		RE::hknpBSWorld* GetPhysicsWorld(RE::Actor*) override
+		{
+			return &world;
+		}
+
+		void BeginPicks(RE::hknpBSWorld*) override
+		{}
+
+		bool Pick(RE::Actor* a_actor, std::uint32_t a_point) override
+		{
+			++picks;
+			return a_actor->visiblePoints & (1u << a_point);
+		}
+
+		// members
+		RE::hknpBSWorld world;
+		std::uint32_t   picks{ 0 };
+	};
+
+	const RE::NiPoint3 cameraPos{ 0.0f, 0.0f, 0.0f };
+	const RE::NiPoint3 actorPos{ 500.0f, 0.0f, 0.0f };
+
+	struct Speaker
+	{
+		RE::ObjectRefHandle handle;
+		RE::Actor           actor;
+		RE::NiPoint3        pos{ actorPos };
+	};
+
+	// what UpdateSubtitleInfo does for each speaker, the result its alpha is worked out from
+	Result show(RaycastScheduler& a_scheduler, VisibilityCache& a_cache, FakeWorld& a_world, Speaker& a_speaker)
+	{
+		if (const auto result = a_cache.Get(a_speaker.handle, cameraPos, a_speaker.pos, Clock::now())) {
+			return *result;
+		}
+		return a_scheduler.Schedule(a_cache, a_world, { a_speaker.handle, &a_speaker.actor, a_speaker.pos, 1.0f, 0.1f }, cameraPos);
+	}
+
+	void test_first_sight()
+	{
+		RaycastScheduler scheduler;
+		VisibilityCache  cache;
+		FakeWorld        world;
+
+		// a speaker in plain view is shown as visible from its first update, not faded in from obscured
+		Speaker visible{ RE::ObjectRefHandle{ 1 }, { 0b0001 } };
+		Test::Check(show(scheduler, cache, world, visible) == Result::kVisible);
+		Test::Check(world.picks == 1);
+		Test::Check(cache.GetLast(visible.handle) == Result::kVisible);
+
+		// and one behind a wall as obscured, after trying every point
+		Speaker hidden{ RE::ObjectRefHandle{ 2 }, { 0 } };
+		Test::Check(show(scheduler, cache, world, hidden) == Result::kObscured);
+		Test::Check(world.picks == 1 + RayBatch::pointCount);
+
+		// both were checked on the spot, nothing is left for Run
+		scheduler.Run(cache, world, cameraPos);
+		Test::Check(world.picks == 1 + RayBatch::pointCount);
+		Test::Check(scheduler.GetFirstChecks() == 2);
+		Test::Check(scheduler.GetChecked() == 0);
+		Test::Check(cache.GetRays() == 1 + RayBatch::pointCount);
+	}
+
+	void test_outside_budget()
+	{
+		RaycastScheduler scheduler;
+		VisibilityCache  cache;
+		FakeWorld        world;
+		scheduler.SetRayBudget(1);
+
+		// a crowd showing up at once is checked in full, whatever the budget
+		std::vector<Speaker> crowd;
+		for (std::uint32_t i = 0; i < 8; ++i) {
+			crowd.push_back({ RE::ObjectRefHandle{ i + 1 }, { i % 2 ? 0b0100u : 0u } });
+		}
+		for (auto& speaker : crowd) {
+			Test::Check(show(scheduler, cache, world, speaker) == (speaker.actor.visiblePoints ? Result::kVisible : Result::kObscured));
+		}
+		Test::Check(scheduler.GetFirstChecks() == crowd.size());
+	}
+
+	void test_stale()
+	{
+		RaycastScheduler scheduler;
+		VisibilityCache  cache;
+		FakeWorld        world;
+
+		Speaker speaker{ RE::ObjectRefHandle{ 1 }, { 0b0001 } };
+		Test::Check(show(scheduler, cache, world, speaker) == Result::kVisible);
+
+		// once it moves the last result stands while the new check waits for Run
+		speaker.pos = { 600.0f, 0.0f, 0.0f };
+		speaker.actor.visiblePoints = 0;
+		const auto picks = world.picks;
+		Test::Check(show(scheduler, cache, world, speaker) == Result::kVisible);
+		Test::Check(world.picks == picks);
+
+		scheduler.Run(cache, world, cameraPos);
+		Test::Check(world.picks > picks);
+		Test::Check(scheduler.GetChecked() == 1);
+		Test::Check(scheduler.GetFirstChecks() == 1);
+	}
+
+	void test_expired()
+	{
+		RaycastScheduler scheduler;
+		VisibilityCache  cache;
+		FakeWorld        world;
+
+		Speaker speaker{ RE::ObjectRefHandle{ 1 }, { 0 } };
+		Test::Check(show(scheduler, cache, world, speaker) == Result::kObscured);
+
+		// dropped after a while out of earshot, coming back into view it is checked on the spot again instead of
+		// fading in from a default
+		cache.Prune(Clock::now() + std::chrono::seconds(3));
+		Test::Check(!cache.GetLast(speaker.handle));
+
+		speaker.actor.visiblePoints = 0b0010;
+		Test::Check(show(scheduler, cache, world, speaker) == Result::kVisible);
+		Test::Check(scheduler.GetFirstChecks() == 2);
+	}
+}
+
+int main()
+{
+	test_first_sight();
+	test_outside_budget();
+	test_stale();
+	test_expired();
+
+	return Test::Result();
+}
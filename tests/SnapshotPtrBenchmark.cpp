@@ -0,0 +1,94 @@
+#include "SnapshotPtr.h"
+
+#include <benchmark/benchmark.h>
+
+// Subtitle lookups from every thread against a writer republishing the index, the way the render and game threads
+// read processed subtitles while new lines are published. SnapshotPtr against the reader/writer lock and atomic
+// shared_ptr it replaces.
+namespace
+{
+	using Index = FlatMap<std::uint64_t, std::shared_ptr<const std::string>>;
+
+	constexpr std::uint64_t indexSize = 16;    // lines on screen at once
+	constexpr std::int64_t  writeEvery = 256;  // lookups per republish on the writing thread
+
+	std::unique_ptr<const Index> make_index(std::uint64_t a_version)
+	{
+		auto index = std::make_unique<Index>();
+		for (std::uint64_t i = 0; i < indexSize; ++i) {
+			index->emplace(i, std::make_shared<const std::string>(std::to_string(a_version + i)));
+		}
+		return index;
+	}
+
+	template <class Lookup, class Publish>
+	void run(benchmark::State& a_state, Lookup&& a_lookup, Publish&& a_publish)
+	{
+		std::uint64_t key = a_state.thread_index();
+		std::int64_t  count = 0;
+		for (auto _ : a_state) {
+			benchmark::DoNotOptimize(a_lookup(key++ % indexSize));
+			if (a_state.thread_index() == 0 && ++count % writeEvery == 0) {
+				a_publish(static_cast<std::uint64_t>(count));
+			}
+		}
+		a_state.SetItemsProcessed(a_state.iterations());
+	}
+
+	void BM_SnapshotPtr(benchmark::State& a_state)
+	{
+		static SnapshotPtr<Index> index(make_index(0));
+		static std::mutex         writeLock;
+
+		run(
+			a_state,
+			[](std::uint64_t a_key) {
+				const auto reader = index.Read();
+				return reader->find(a_key)->second;
+			},
+			[](std::uint64_t a_version) {
+				auto             next = make_index(a_version);
+				std::scoped_lock locker(writeLock);
+				index.Publish(std::move(next));
+			});
+	}
+
+	void BM_SharedMutex(benchmark::State& a_state)
+	{
+		static std::shared_ptr<const Index> index(make_index(0));
+		static std::shared_mutex            lock;
+
+		run(
+			a_state,
+			[](std::uint64_t a_key) {
+				std::shared_lock locker(lock);
+				return index->find(a_key)->second;
+			},
+			[](std::uint64_t a_version) {
+				std::shared_ptr<const Index> next(make_index(a_version));
+				std::unique_lock             locker(lock);
+				index = std::move(next);
+			});
+	}
+
+	void BM_AtomicSharedPtr(benchmark::State& a_state)
+	{
+		static std::atomic<std::shared_ptr<const Index>> index(make_index(0));
+
+		run(
+			a_state,
+			[](std::uint64_t a_key) {
+				const auto snapshot = index.load();
+				return snapshot->find(a_key)->second;
+			},
+			[](std::uint64_t a_version) {
+				index.store(make_index(a_version));
+			});
+	}
+}
+
+BENCHMARK(BM_SnapshotPtr)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_SharedMutex)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_AtomicSharedPtr)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
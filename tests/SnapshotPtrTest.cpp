@@ -0,0 +1,127 @@
+#include "SnapshotPtr.h"
+
+namespace
+{
+	constexpr std::uint64_t liveMagic = 0x5AB5'5AB5'5AB5'5AB5;
+	constexpr std::uint64_t deadMagic = 0xDEAD'DEAD'DEAD'DEAD;
+
+	std::atomic<std::int32_t> alive{ 0 };
+
+	// poisoned when freed, a reader that still sees it finds the magic overwritten
+	struct Snapshot
+	{
+		explicit Snapshot(std::uint64_t a_version) :
+			version(a_version)
+		{
+			values.fill(a_version);
+			++alive;
+		}
+
+		~Snapshot()
+		{
+			magic = deadMagic;
+			values.fill(0);
+			--alive;
+		}
+
+		bool IsIntact() const
+		{
+			return magic == liveMagic && std::ranges::all_of(values, [&](auto a_value) { return a_value == version; });
+		}
+
+		// members
+		std::uint64_t                magic{ liveMagic };
+		std::uint64_t                version;
+		std::array<std::uint64_t, 8> values{};
+	};
+
+	void test_reclaim()
+	{
+		{
+			SnapshotPtr<Snapshot> ptr(std::make_unique<const Snapshot>(0));
+
+			// nobody reading, replaced snapshots are freed right away
+			ptr.Publish(std::make_unique<const Snapshot>(1));
+			Test::Check(alive == 1 && ptr.GetRetiredCount() == 0);
+			Test::Check(ptr.Get().version == 1);
+
+			// a reader keeps its snapshot, and whatever was retired after it, until it's gone
+			{
+				const auto reader = ptr.Read();
+				ptr.Publish(std::make_unique<const Snapshot>(2));
+				ptr.Publish(std::make_unique<const Snapshot>(3));
+				ptr.Publish(std::make_unique<const Snapshot>(4));
+				Test::Check(reader->version == 1 && reader->IsIntact());
+				Test::Check(ptr.Read()->version == 4);
+				Test::Check(alive == 4);
+			}
+
+			ptr.Publish(std::make_unique<const Snapshot>(5));
+			Test::Check(alive == 1 && ptr.GetRetiredCount() == 0);
+		}
+		Test::Check(alive == 0);
+	}
+
+	// readers never see a freed snapshot and never go back in time while writers keep replacing it
+	void test_stress()
+	{
+		const auto readerCount = std::max(std::thread::hardware_concurrency(), 4u) - 1;
+		constexpr std::uint64_t publishes = 100000;
+
+		{
+			SnapshotPtr<Snapshot>      ptr(std::make_unique<const Snapshot>(0));
+			std::mutex                 writeLock;  // the caller serializes writers
+			std::atomic_bool           done{ false };
+			std::atomic<std::uint32_t> failures{ 0 };
+
+			std::vector<std::jthread> threads;
+			for (std::uint32_t i = 0; i < readerCount; ++i) {
+				threads.emplace_back([&]() {
+					std::uint64_t last = 0;
+					while (!done.load(std::memory_order_relaxed)) {
+						const auto reader = ptr.Read();
+						if (!reader->IsIntact() || reader->version < last) {
+							++failures;
+						}
+						last = reader->version;
+					}
+				});
+			}
+
+			// two writers taking turns
+			std::atomic<std::uint64_t> version{ 0 };
+			for (std::uint32_t i = 0; i < 2; ++i) {
+				threads.emplace_back([&]() {
+					while (true) {
+						std::scoped_lock locker(writeLock);
+						if (version == publishes) {
+							return;
+						}
+						ptr.Publish(std::make_unique<const Snapshot>(++version));
+					}
+				});
+			}
+
+			threads[readerCount].join();
+			threads[readerCount + 1].join();
+			done = true;
+			threads.clear();
+
+			Test::Check(failures == 0);
+			Test::Check(ptr.Read()->version == publishes);
+
+			// with the readers gone the next publish frees everything retired
+			ptr.Publish(std::make_unique<const Snapshot>(publishes + 1));
+			Test::Check(alive == 1 && ptr.GetRetiredCount() == 0);
+		}
+		Test::Check(alive == 0);
+	}
+}
+
+int main()
+{
+	test_reclaim();
+	test_stress();
+
+	return Test::Result();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "LocalizedStringTable.h"
+
+// String table files built in memory, for the tests and benchmarks that read them.
+class StringTableBuilder
+{
+public:
+	using Type = RE::LocalizedStringTable::Type;
+
+	explicit StringTableBuilder(Type a_type) :
+		type(a_type)
+	{}
+
+	StringTableBuilder& Add(std::uint32_t a_stringID, std::string_view a_string)
+	{
+		directory.push_back({ a_stringID, static_cast<std::uint32_t>(data.size()) });
+		if (RE::LocalizedStringTable::IsLengthPrefixed(type)) {
+			append(static_cast<std::uint32_t>(a_string.size() + 1));
+		}
+		data.insert(data.end(), reinterpret_cast<const std::byte*>(a_string.data()), reinterpret_cast<const std::byte*>(a_string.data() + a_string.size()));
+		data.push_back(std::byte{ 0 });
+		return *this;
+	}
+
+	// raw directory entry, the offset is not checked against the data
+	StringTableBuilder& AddRaw(std::uint32_t a_stringID, std::uint32_t a_offset)
+	{
+		directory.push_back({ a_stringID, a_offset });
+		return *this;
+	}
+
+	StringTableBuilder& AppendData(std::span<const std::byte> a_bytes)
+	{
+		data.insert(data.end(), a_bytes.begin(), a_bytes.end());
+		return *this;
+	}
+
+	std::vector<std::byte> Build(std::optional<std::uint32_t> a_entryCount = std::nullopt, std::optional<std::uint32_t> a_dataSize = std::nullopt) const
+	{
+		std::vector<std::byte> result;
+		result.reserve(8 + directory.size() * 8 + data.size());
+		const auto write = [&](const void* a_data, std::size_t a_size) {
+			if (a_size == 0) {
+				return;  // an empty data block has no pointer to copy from
+			}
+			const auto pos = result.size();
+			result.resize(pos + a_size);
+			std::memcpy(result.data() + pos, a_data, a_size);
+		};
+		const auto write_value = [&](std::uint32_t a_value) { write(&a_value, sizeof(a_value)); };
+
+		write_value(a_entryCount.value_or(static_cast<std::uint32_t>(directory.size())));
+		write_value(a_dataSize.value_or(static_cast<std::uint32_t>(data.size())));
+		for (const auto& [stringID, offset] : directory) {
+			write_value(stringID);
+			write_value(offset);
+		}
+		write(data.data(), data.size());
+		return result;
+	}
+
+	// a_count dialogue-like lines of 4 to 19 words, the same for the same seed
+	static std::vector<std::byte> Generate(Type a_type, std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		static constexpr std::array words{ "the"sv, "settlement"sv, "needs"sv, "your"sv, "help"sv, "general"sv, "I'll"sv, "mark"sv,
+			"it"sv, "on"sv, "your"sv, "map"sv, "Diamond"sv, "City"sv, "raiders"sv, "are"sv, "attacking"sv, "Preston"sv, "we"sv,
+			"should"sv, "go"sv, "now"sv, "Vault"sv, "Institute"sv, "synth"sv, "caps"sv, "water"sv, "purified"sv };
+
+		std::mt19937       rng(a_seed);
+		StringTableBuilder builder(a_type);
+		std::string        line;
+		for (std::uint32_t i = 0; i < a_count; ++i) {
+			line.clear();
+			for (auto wordCount = 4 + rng() % 16; wordCount > 0; --wordCount) {
+				line += words[rng() % words.size()];
+				line += wordCount > 1 ? ' ' : '.';
+			}
+			builder.Add(i + 1, line);
+		}
+		return builder.Build();
+	}
+
+private:
+	void append(std::uint32_t a_value)
+	{
+		const auto bytes = std::bit_cast<std::array<std::byte, 4>>(a_value);
+		data.insert(data.end(), bytes.begin(), bytes.end());
+	}
+
+	// members
+	Type                                                  type;
+	std::vector<RE::LocalizedStringTable::DirectoryEntry> directory;
+	std::vector<std::byte>                                data;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// Every test is its own executable, failed checks are printed and the exit code tells ctest.
+namespace Test
+{
+	inline constexpr int skipped = 77;  // SKIP_RETURN_CODE, the test could not run here
+
+	inline std::uint32_t failures{ 0 };
+
+	inline bool Check(bool a_condition, std::source_location a_location = std::source_location::current())
+	{
+		if (!a_condition) {
+			std::fprintf(stderr, "%s:%u: check failed in %s\n", a_location.file_name(), a_location.line(), a_location.function_name());
+			++failures;
+		}
+		return a_condition;
+	}
+
+	inline int Result()
+	{
+		if (failures) {
+			std::fprintf(stderr, "%u checks failed\n", failures);
+			return 1;
+		}
+		return 0;
+	}
+}
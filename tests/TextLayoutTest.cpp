@@ -0,0 +1,288 @@
+#include "TextLayout.h"
+
+namespace
+{
+	// ASCII is one unit wide, ideographs three, everything else two
+	float advance_of(char32_t a_codePoint)
+	{
+		if (a_codePoint < 0x80) {
+			return 1.0f;
+		}
+		if (a_codePoint == 0xFFFD) {
+			return 1.5f;
+		}
+		return a_codePoint >= 0x4E00 && a_codePoint <= 0x9FFF ? 3.0f : 2.0f;
+	}
+
+	// every glyph the tests use measured, the way the render thread extends the table
+	const GlyphAdvanceTable& get_advances()
+	{
+		static const auto advances = [] {
+			const GlyphAdvanceTable base(advance_of, 16.0f);
+
+			FlatSet<char32_t> missing;
+			base.GetMissing("éжあっ字😀", missing);
+			const std::vector<char32_t> codePoints(missing.begin(), missing.end());
+			return GlyphAdvanceTable(base, codePoints, advance_of);
+		}();
+		return advances;
+	}
+
+	std::vector<std::string_view> to_strings(std::string_view a_text, const std::vector<TextLayout::Line>& a_lines)
+	{
+		std::vector<std::string_view> result;
+		for (const auto& [offset, length, width] : a_lines) {
+			result.push_back(a_text.substr(offset, length));
+		}
+		return result;
+	}
+
+	void test_advances()
+	{
+		std::size_t queries = 0;
+		std::size_t ideographQueries = 0;
+
+		const auto source = [&](char32_t a_codePoint) {
+			++queries;
+			ideographQueries += a_codePoint >= 0x4E00 && a_codePoint <= 0x9FFF;
+			return advance_of(a_codePoint);
+		};
+
+		// printable ASCII and the replacement character only
+		const GlyphAdvanceTable advances(source, 16.0f);
+		Test::Check(queries == 0x7F - 0x20 + 1);
+		Test::Check(advances.GetFontSize() == 16.0f);
+		Test::Check(advances.GetAverageAdvance() == 1.0f);
+
+		Test::Check(advances.GetAdvance('a') == 1.0f);
+		Test::Check(advances.Contains('a') && !advances.Contains(U'é'));
+		Test::Check(advances.GetAdvance(U'é') == 1.5f);  // not measured yet, fallback
+
+		FlatSet<char32_t> missing;
+		advances.GetMissing("plain ASCII", missing);
+		Test::Check(missing.empty());
+		advances.GetMissing("éé 字一", missing);
+		Test::Check(missing == FlatSet<char32_t>{ U'é', U'字', U'一' });
+
+		queries = 0;
+		const std::vector<char32_t> codePoints(missing.begin(), missing.end());
+		const GlyphAdvanceTable extended(advances, codePoints, source);
+		Test::Check(queries == 2 && ideographQueries == 1);  // 字 and 一 share a uniform block, measured once
+		Test::Check(extended.GetFontSize() == 16.0f);
+
+		Test::Check(extended.GetAdvance('a') == 1.0f);
+		Test::Check(extended.GetAdvance(U'é') == 2.0f);
+		Test::Check(extended.GetAdvance(U'字') == 3.0f);
+		Test::Check(extended.GetAdvance(U'丁') == 3.0f);  // same block, never asked for
+		Test::Check(extended.GetAdvance(U'ж') == 1.5f);
+		Test::Check(extended.GetAdvance(U'😀') == 1.5f);
+
+		missing.clear();
+		extended.GetMissing("é字丁ж", missing);
+		Test::Check(missing == FlatSet<char32_t>{ U'ж' });
+	}
+
+	void test_wrap_width()
+	{
+		const auto& advances = get_advances();
+
+		constexpr auto text = "the quick brown fox"sv;
+
+		const auto lines = TextLayout::Wrap(TextLayout::Script::kLatin, text, 9.0f, advances);
+		Test::Check(to_strings(text, lines) == std::vector{ "the quick"sv, "brown fox"sv });
+		Test::Check(lines.size() == 2 && lines[0].width == 9.0f && lines[1].width == 9.0f);
+
+		// one past the width moves the word down, trailing spaces are not counted
+		Test::Check(to_strings(text, TextLayout::Wrap(TextLayout::Script::kLatin, text, 8.0f, advances)) == std::vector{ "the"sv, "quick"sv, "brown"sv, "fox"sv });
+		Test::Check(to_strings(text, TextLayout::Wrap(TextLayout::Script::kLatin, text, 100.0f, advances)) == std::vector{ text });
+
+		// no break opportunity, split between characters
+		constexpr auto word = "abcdefghij"sv;
+		Test::Check(to_strings(word, TextLayout::Wrap(TextLayout::Script::kLatin, word, 4.0f, advances)) == std::vector{ "abcd"sv, "efgh"sv, "ij"sv });
+
+		// mandatory breaks end the line whatever the width
+		constexpr auto breaks = "one\ntwo\r\n\nthree"sv;
+		Test::Check(to_strings(breaks, TextLayout::Wrap(TextLayout::Script::kLatin, breaks, 100.0f, advances)) == std::vector{ "one"sv, "two"sv, "three"sv });
+
+		// ideographs are wider, break between any two
+		constexpr auto ideographs = "字字字字字"sv;
+		Test::Check(to_strings(ideographs, TextLayout::Wrap(TextLayout::Script::kCJK, ideographs, 7.0f, advances)) == std::vector{ "字字"sv, "字字"sv, "字"sv });
+
+		Test::Check(TextLayout::Wrap(TextLayout::Script::kLatin, "", 10.0f, advances).empty());
+		Test::Check(TextLayout::Wrap(TextLayout::Script::kLatin, "   ", 10.0f, advances).empty());
+	}
+
+	// the setting counts code points, not bytes or widths
+	void test_max_width()
+	{
+		const auto& advances = get_advances();
+
+		Test::Check(std::isinf(TextLayout::GetMaxWidth("字字字字", 4, advances)));
+		Test::Check(TextLayout::GetMaxWidth("字字字字字", 4, advances) == 4.0f);
+		Test::Check(TextLayout::GetMaxWidth("word word", 4, advances) == 4.0f);
+		Test::Check(std::isinf(TextLayout::GetMaxWidth("", 0, advances)));
+
+		// within the setting only the mandatory break splits it, though it is far wider than 8 average characters
+		const auto text = "字字 字字\n字"sv;
+		const auto lines = TextLayout::Wrap(TextLayout::Script::kCJK, text, TextLayout::GetMaxWidth(text, 8, advances), advances);
+		Test::Check(to_strings(text, lines) == std::vector{ "字字 字字"sv, "字"sv });
+		Test::Check(lines[0].width == 13.0f);
+	}
+
+	std::string make_text(std::mt19937& a_rng)
+	{
+		static constexpr std::array<std::string_view, 13> pieces{
+			"a"sv, "word"sv, "subtitle"sv, " "sv, "  "sv, "-"sv, "\n"sv, "\r\n"sv, "é"sv, "жж"sv, "字"sv, "あっ"sv, "😀"sv
+		};
+
+		std::string text;
+		for (auto n = std::uniform_int_distribution<std::size_t>(0, 60)(a_rng); n > 0; --n) {
+			text += pieces[std::uniform_int_distribution<std::size_t>(0, pieces.size() - 1)(a_rng)];
+		}
+		return text;
+	}
+
+	// every line is a span of the text in order, trimmed, measured, and together they hold all of it but the whitespace
+	void check_spans(std::string_view a_text, const std::vector<TextLayout::Line>& a_lines, float a_maxWidth)
+	{
+		const auto& advances = get_advances();
+
+		const auto is_space = [](char a_ch) { return a_ch == ' ' || a_ch == '\r' || a_ch == '\n'; };
+
+		std::size_t end = 0;
+		std::size_t covered = 0;
+		for (const auto& [offset, length, width] : a_lines) {
+			if (!Test::Check(offset >= end && length > 0 && offset + length <= a_text.size())) {
+				return;
+			}
+			end = offset + length;
+			covered += std::ranges::count_if(a_text.substr(offset, length), std::not_fn(is_space));
+
+			const auto line = a_text.substr(offset, length);
+			Test::Check(!is_space(line.front()) && !is_space(line.back()));
+			Test::Check(line.find('\n') == std::string_view::npos);
+
+			float measured = 0.0f;
+			for (std::size_t pos = 0; pos < line.size();) {
+				measured += advances.GetAdvance(TextLayout::DecodeUTF8(line, pos));
+			}
+			Test::Check(width == measured && width <= a_maxWidth);
+		}
+
+		Test::Check(covered == static_cast<std::size_t>(std::ranges::count_if(a_text, std::not_fn(is_space))));
+	}
+
+	void test_lines_are_spans()
+	{
+		std::mt19937 rng(17);
+		for (std::size_t i = 0; i < 2000; ++i) {
+			const auto text = make_text(rng);
+			for (const auto maxWidth : { 3.0f, 8.0f, 20.0f, 1000.0f }) {
+				for (const auto script : { TextLayout::Script::kLatin, TextLayout::Script::kCyrillic, TextLayout::Script::kCJK, TextLayout::Script::kJapanese }) {
+					check_spans(text, TextLayout::Wrap(script, text, maxWidth, get_advances()), maxWidth);
+				}
+			}
+		}
+	}
+
+	void test_wrapped_text()
+	{
+		const TextLayout::WrappedText empty;
+		Test::Check(empty.empty() && empty.GetText().empty() && empty.GetLines().empty() && empty.GetMemoryUsage() == 0);
+
+		// a reused buffer gives the same lines as a fresh one
+		std::vector<TextLayout::Line> lines;
+		for (const auto text : { "the quick brown fox"sv, "jumps"sv, "éжあっ字 over the lazy dog"sv }) {
+			TextLayout::Wrap(TextLayout::Script::kLatin, text, 8.0f, get_advances(), lines);
+			Test::Check(to_strings(text, lines) == to_strings(text, TextLayout::Wrap(TextLayout::Script::kLatin, text, 8.0f, get_advances())));
+
+			// text and lines copied together, the text still null terminated
+			const TextLayout::WrappedText wrapped(text, lines);
+			Test::Check(wrapped.GetText() == text && wrapped.GetText().data()[text.size()] == '\0');
+			Test::Check(to_strings(wrapped.GetText(), { wrapped.GetLines().begin(), wrapped.GetLines().end() }) == to_strings(text, lines));
+			Test::Check(wrapped.GetMemoryUsage() >= text.size() + 1 + lines.size() * sizeof(TextLayout::Line));
+		}
+
+		// not wrapped
+		const TextLayout::WrappedText unwrapped("abc"sv, {});
+		Test::Check(unwrapped.GetText() == "abc" && unwrapped.GetLines().empty());
+	}
+
+	void test_get_script()
+	{
+		using TextLayout::Script;
+
+		// translations, the language alone decides
+		Test::Check(TextLayout::GetScript(Language::kJapanese) == Script::kJapanese);
+		Test::Check(TextLayout::GetScript(Language::kChinese) == Script::kCJK);
+		Test::Check(TextLayout::GetScript(Language::kRussian) == Script::kCyrillic);
+		Test::Check(TextLayout::GetScript(Language::kEnglish) == Script::kLatin);
+		Test::Check(TextLayout::GetScript(Language::kPolish) == Script::kLatin);
+
+		// the game's own text
+		Test::Check(TextLayout::GetScript(Language::kJapanese, "plain ASCII") == Script::kJapanese);
+		Test::Check(TextLayout::GetScript(Language::kChinese, "plain ASCII") == Script::kCJK);
+		Test::Check(TextLayout::GetScript(Language::kRussian, "Привет") == Script::kCyrillic);
+		Test::Check(TextLayout::GetScript(Language::kEnglish, "Hello") == Script::kLatin);
+		Test::Check(TextLayout::GetScript(Language::kFrench, "Déjà vu") == Script::kLatin);
+
+		// the language cannot tell, the text does
+		Test::Check(TextLayout::GetScript(Language::kEnglish, "Untranslated 字幕") == Script::kCJK);
+		Test::Check(TextLayout::GetScript(Language::kRussian, "こんにちは") == Script::kCJK);
+	}
+
+	void test_kinsoku()
+	{
+		const auto& advances = get_advances();
+
+		// small tsu cannot start a line under strict kinsoku, Chinese text lets it
+		constexpr auto text = "ああっあ"sv;
+		Test::Check(to_strings(text, TextLayout::Wrap(TextLayout::Script::kJapanese, text, 4.0f, advances)) == std::vector{ "あ"sv, "あっ"sv, "あ"sv });
+		Test::Check(to_strings(text, TextLayout::Wrap(TextLayout::Script::kCJK, text, 4.0f, advances)) == std::vector{ "ああ"sv, "っあ"sv });
+	}
+
+	// the policies only differ in how they decode and in CJ, so they must agree on anything else, malformed input included
+	void test_scripts_agree()
+	{
+		const auto& advances = get_advances();
+
+		const auto same = [](const std::vector<TextLayout::Line>& a_lhs, const std::vector<TextLayout::Line>& a_rhs) {
+			return std::ranges::equal(a_lhs, a_rhs, [](const TextLayout::Line& a_l, const TextLayout::Line& a_r) {
+				return a_l.offset == a_r.offset && a_l.length == a_r.length && a_l.width == a_r.width;
+			});
+		};
+
+		static constexpr std::array<std::string_view, 4> damage{ "\xC3"sv, "\xE5\xAD"sv, "\x80"sv, "\xF0\xA0\x80"sv };
+
+		std::mt19937 rng(20);
+		for (std::size_t i = 0; i < 2000; ++i) {
+			auto text = make_text(rng);
+			if (!text.empty() && i % 2 == 0) {
+				text.insert(std::uniform_int_distribution<std::size_t>(0, text.size())(rng), damage[i % damage.size()]);
+			}
+
+			for (const auto maxWidth : { 3.0f, 8.0f, 20.0f }) {
+				const auto latin = TextLayout::Wrap(TextLayout::Script::kLatin, text, maxWidth, advances);
+				Test::Check(same(latin, TextLayout::Wrap(TextLayout::Script::kCyrillic, text, maxWidth, advances)));
+				Test::Check(same(latin, TextLayout::Wrap(TextLayout::Script::kJapanese, text, maxWidth, advances)));
+				if (text.find("っ") == std::string::npos) {
+					Test::Check(same(latin, TextLayout::Wrap(TextLayout::Script::kCJK, text, maxWidth, advances)));
+				}
+			}
+		}
+	}
+}
+
+int main()
+{
+	test_advances();
+	test_wrap_width();
+	test_max_width();
+	test_lines_are_spans();
+	test_wrapped_text();
+	test_get_script();
+	test_kinsoku();
+	test_scripts_agree();
+
+	return Test::Result();
+}
@@ -0,0 +1,84 @@
+#include "UTF8.h"
+
+#include <benchmark/benchmark.h>
+
+// The whole-string checks over subtitle-sized lines in three scripts, on every kernel the CPU supports.
+namespace
+{
+	constexpr std::size_t corpusSize = 1 << 20;
+
+	// lines of 4 to 15 words, until the corpus size is reached
+	std::string make_corpus(std::initializer_list<std::string_view> a_words, std::string_view a_separator)
+	{
+		std::string   corpus;
+		std::uint32_t seed = 12345;
+		while (corpus.size() < corpusSize) {
+			const auto wordCount = 4 + seed % 12;
+			for (std::uint32_t i = 0; i < wordCount; ++i) {
+				seed = seed * 1103515245 + 12345;
+				if (i > 0) {
+					corpus += a_separator;
+				}
+				corpus += *(a_words.begin() + (seed >> 16) % a_words.size());
+			}
+			corpus += '\n';
+		}
+		return corpus;
+	}
+
+	const std::string& get_corpus(std::string_view a_script)
+	{
+		static const std::string latin = make_corpus({ "I", "used", "to", "be", "an", "adventurer", "like", "you", "then", "took", "arrow", "in", "the", "knee", "Settlement", "needs", "help" }, " ");
+		static const std::string cyrillic = make_corpus({ "Ещё", "одному", "поселению", "нужна", "ваша", "помощь", "Я", "отмечу", "его", "на", "карте", "Минитмены" }, " ");
+		static const std::string cjk = make_corpus({ "また", "居住地", "が", "助け", "を", "求めて", "いる", "地図", "に", "印", "を", "付けて", "おく", "ミニッツメン" }, "");
+
+		return a_script == "Latin" ? latin : a_script == "Cyrillic" ? cyrillic : cjk;
+	}
+
+	template <class Function>
+	void run(benchmark::State& a_state, UTF8::Kernel a_kernel, std::string_view a_script, Function a_function)
+	{
+		const auto& corpus = get_corpus(a_script);
+		UTF8::SetKernel(a_kernel);
+		for (auto _ : a_state) {
+			benchmark::DoNotOptimize(a_function(corpus));
+		}
+		a_state.SetBytesProcessed(a_state.iterations() * static_cast<std::int64_t>(corpus.size()));
+	}
+
+	template <class Function>
+	void register_all(std::string_view a_name, Function a_function)
+	{
+		constexpr std::array kernels{
+			std::pair{ UTF8::Kernel::kSWAR, "SWAR" },
+			std::pair{ UTF8::Kernel::kSSE42, "SSE42" },
+			std::pair{ UTF8::Kernel::kAVX2, "AVX2" }
+		};
+
+		for (const auto& [kernel, kernelName] : kernels) {
+			if (!UTF8::IsSupported(kernel)) {
+				continue;
+			}
+			for (const std::string_view script : { "Latin", "Cyrillic", "CJK" }) {
+				const auto name = std::string(a_name) + "/" + kernelName + "/" + std::string(script);
+				benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& a_state) {
+					run(a_state, kernel, script, a_function);
+				});
+			}
+		}
+	}
+}
+
+int main(int a_argc, char** a_argv)
+{
+	register_all("IsASCII", [](std::string_view a_text) { return UTF8::IsASCII(a_text); });
+	register_all("IsValid", [](std::string_view a_text) { return UTF8::IsValid(a_text); });
+	register_all("CountCodePoints", [](std::string_view a_text) { return UTF8::CountCodePoints(a_text); });
+	register_all("ContainsCJK", [](std::string_view a_text) { return UTF8::ContainsCJK(a_text); });
+
+	benchmark::Initialize(&a_argc, a_argv);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
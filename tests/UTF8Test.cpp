@@ -0,0 +1,269 @@
+#include "UTF8.h"
+
+// The kernels against a byte at a time reference, every kernel this machine supports in turn.
+namespace
+{
+	// decodes one sequence by the book, returns its length or 0 when it is not well-formed
+	std::size_t decode_reference(std::string_view a_text, std::size_t a_pos, char32_t& a_codePoint)
+	{
+		const auto lead = static_cast<unsigned char>(a_text[a_pos]);
+		if (lead < 0x80) {
+			a_codePoint = lead;
+			return 1;
+		}
+
+		std::size_t length = 0;
+		if (lead >= 0xC0 && lead < 0xE0) {
+			length = 2;
+		} else if (lead >= 0xE0 && lead < 0xF0) {
+			length = 3;
+		} else if (lead >= 0xF0 && lead < 0xF8) {
+			length = 4;
+		} else {
+			return 0;
+		}
+		if (a_text.size() - a_pos < length) {
+			return 0;
+		}
+
+		a_codePoint = lead & (0x7F >> length);
+		for (std::size_t i = 1; i < length; ++i) {
+			const auto next = static_cast<unsigned char>(a_text[a_pos + i]);
+			if (next < 0x80 || next > 0xBF) {
+				return 0;
+			}
+			a_codePoint = (a_codePoint << 6) | (next & 0x3F);
+		}
+
+		constexpr std::array<char32_t, 5> shortest{ 0, 0, 0x80, 0x800, 0x10000 };
+		if (a_codePoint < shortest[length] || a_codePoint > 0x10FFFF || (a_codePoint >= 0xD800 && a_codePoint <= 0xDFFF)) {
+			return 0;
+		}
+		return length;
+	}
+
+	bool is_ascii_reference(std::string_view a_text)
+	{
+		return std::ranges::all_of(a_text, [](char a_ch) { return static_cast<unsigned char>(a_ch) < 0x80; });
+	}
+
+	bool is_valid_reference(std::string_view a_text)
+	{
+		for (std::size_t i = 0; i < a_text.size();) {
+			char32_t   cp;
+			const auto length = decode_reference(a_text, i, cp);
+			if (length == 0) {
+				return false;
+			}
+			i += length;
+		}
+		return true;
+	}
+
+	// bytes that are not continuation bytes, the code points of valid text
+	std::size_t count_code_points_reference(std::string_view a_text)
+	{
+		return static_cast<std::size_t>(std::ranges::count_if(a_text, [](char a_ch) { return (static_cast<unsigned char>(a_ch) & 0xC0) != 0x80; }));
+	}
+
+	// any well-formed sequence decoding to CJK, wherever it starts
+	bool contains_cjk_reference(std::string_view a_text)
+	{
+		for (std::size_t i = 0; i < a_text.size(); ++i) {
+			char32_t cp;
+			if (decode_reference(a_text, i, cp) > 1 &&
+				((cp >= 0x3040 && cp <= 0x30FF) || (cp >= 0x3400 && cp <= 0x4DBF) || (cp >= 0x4E00 && cp <= 0x9FFF) ||
+					(cp >= 0xAC00 && cp <= 0xD7AF) || (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0x20000 && cp <= 0x2FA1F))) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void append_utf8(std::string& a_text, char32_t a_codePoint)
+	{
+		if (a_codePoint < 0x80) {
+			a_text += static_cast<char>(a_codePoint);
+		} else if (a_codePoint < 0x800) {
+			a_text += static_cast<char>(0xC0 | (a_codePoint >> 6));
+			a_text += static_cast<char>(0x80 | (a_codePoint & 0x3F));
+		} else if (a_codePoint < 0x10000) {
+			a_text += static_cast<char>(0xE0 | (a_codePoint >> 12));
+			a_text += static_cast<char>(0x80 | ((a_codePoint >> 6) & 0x3F));
+			a_text += static_cast<char>(0x80 | (a_codePoint & 0x3F));
+		} else {
+			a_text += static_cast<char>(0xF0 | (a_codePoint >> 18));
+			a_text += static_cast<char>(0x80 | ((a_codePoint >> 12) & 0x3F));
+			a_text += static_cast<char>(0x80 | ((a_codePoint >> 6) & 0x3F));
+			a_text += static_cast<char>(0x80 | (a_codePoint & 0x3F));
+		}
+	}
+
+	// subtitle-like text, mostly ASCII runs with the odd character from other scripts and some damage
+	std::string make_text(std::mt19937& a_rng)
+	{
+		static constexpr std::array<std::pair<char32_t, char32_t>, 10> blocks{ {
+			{ 0x00A0, 0x024F },    // latin
+			{ 0x0400, 0x04FF },    // cyrillic
+			{ 0x2000, 0x206F },    // punctuation, lead byte 0xE2
+			{ 0x3000, 0x303F },    // cjk punctuation, lead 0xE3 but not CJK
+			{ 0x3040, 0x30FF },    // kana
+			{ 0x4E00, 0x9FFF },    // ideographs
+			{ 0xAC00, 0xD7A3 },    // hangul
+			{ 0xE000, 0xF8FF },    // private use, lead 0xEE
+			{ 0x1F300, 0x1F5FF },  // emoji
+			{ 0x20000, 0x2A6DF },  // ideographs past the BMP
+		} };
+
+		static constexpr std::array<std::string_view, 10> damage{
+			"\x80"sv,                // stray continuation
+			"\xC0\xAF"sv,            // overlong
+			"\xE0\x80\xAF"sv,        // overlong
+			"\xED\xA0\x80"sv,        // surrogate
+			"\xF4\x90\x80\x80"sv,    // past U+10FFFF
+			"\xF5\x80\x80\x80"sv,    // invalid lead
+			"\xE4\xB8"sv,            // truncated ideograph
+			"\xE3\x81\x41"sv,        // truncated kana followed by ASCII
+			"\xFF"sv,
+			"\xC3"sv,
+		};
+
+		const auto random = [&](std::size_t a_max) { return std::uniform_int_distribution<std::size_t>(0, a_max)(a_rng); };
+
+		const auto  damaged = random(3) == 0;
+		std::string text;
+		for (auto pieces = random(12); pieces > 0; --pieces) {
+			for (auto n = random(40); n > 0; --n) {
+				text += static_cast<char>(' ' + random(94));
+			}
+			if (random(3) == 0) {
+				const auto& [first, last] = blocks[random(blocks.size() - 1)];
+				for (auto n = 1 + random(4); n > 0; --n) {
+					append_utf8(text, static_cast<char32_t>(first + random(last - first)));
+				}
+			}
+			if (damaged && random(4) == 0) {
+				text += damage[random(damage.size() - 1)];
+			}
+		}
+		return text;
+	}
+
+	void check_all(std::string_view a_text)
+	{
+		Test::Check(UTF8::IsASCII(a_text) == is_ascii_reference(a_text));
+		Test::Check(UTF8::IsValid(a_text) == is_valid_reference(a_text));
+		Test::Check(UTF8::CountCodePoints(a_text) == count_code_points_reference(a_text));
+		Test::Check(UTF8::ContainsCJK(a_text) == contains_cjk_reference(a_text));
+	}
+
+	void test_known_answers()
+	{
+		Test::Check(UTF8::IsASCII(""));
+		Test::Check(UTF8::IsValid(""));
+		Test::Check(UTF8::CountCodePoints("") == 0);
+		Test::Check(!UTF8::ContainsCJK(""));
+
+		Test::Check(UTF8::IsASCII("The quick brown fox jumps over the lazy dog, again and again."));
+		Test::Check(!UTF8::IsASCII("The quick brown fox jumps over the lazy dog, again and agaín."));
+
+		Test::Check(UTF8::IsValid("Привет, это проверка. こんにちは 안녕하세요 😀"));
+		Test::Check(!UTF8::IsValid("Overlong slash \xC0\xAF in an otherwise fine line of text"));
+		Test::Check(!UTF8::IsValid("Surrogate \xED\xA0\x80 in an otherwise fine line of text"));
+		Test::Check(!UTF8::IsValid("Truncated at the very end \xE4\xB8"));
+		Test::Check(!UTF8::IsValid("Past U+10FFFF \xF4\x90\x80\x80 in an otherwise fine line of text"));
+
+		Test::Check(UTF8::CountCodePoints("Привет, это проверка. こんにちは 안녕하세요 😀") == 35);
+
+		Test::Check(UTF8::ContainsCJK("Only one ideograph, right at the end of a long ASCII line: 字"));
+		Test::Check(UTF8::ContainsCJK("ひらがな"));
+		Test::Check(UTF8::ContainsCJK("한국어"));
+		Test::Check(!UTF8::ContainsCJK("CJK punctuation alone is not CJK text 「」、。"));
+		Test::Check(!UTF8::ContainsCJK("Truncated ideograph \xE4\xB8 and nothing else"));
+	}
+
+	void test_random_text()
+	{
+		std::mt19937 rng(19);
+		for (std::size_t i = 0; i < 5000; ++i) {
+			const auto text = make_text(rng);
+			check_all(text);
+
+			// every alignment of the tail against the vector width
+			for (std::size_t offset = 1; offset < std::min<std::size_t>(text.size(), 33); ++offset) {
+				check_all(std::string_view(text).substr(offset));
+			}
+		}
+	}
+
+	// every two byte string, and three and four byte strings starting with a lead byte followed by a continuation with
+	// one byte of each class after it, placed at and across the block boundaries of every kernel
+	void test_exhaustive()
+	{
+		static constexpr std::array<std::uint8_t, 18> classes{ 0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC2, 0xDF, 0xE0, 0xED, 0xF0, 0xF4, 0xF5, 0xFF };
+
+		const std::string text(64, 'a');
+
+		const auto check_at = [&](std::string_view a_bytes) {
+			for (const auto pos : { std::size_t{ 0 }, std::size_t{ 6 }, std::size_t{ 14 }, std::size_t{ 30 }, 64 - a_bytes.size() }) {
+				std::string copy(text);
+				std::ranges::copy(a_bytes, copy.begin() + pos);
+				Test::Check(UTF8::IsValid(copy) == is_valid_reference(copy));
+			}
+		};
+
+		for (std::uint32_t first = 0x80; first <= 0xFF; ++first) {
+			for (std::uint32_t second = 0; second <= 0xFF; ++second) {
+				const char pair[]{ static_cast<char>(first), static_cast<char>(second) };
+				check_at({ pair, 2 });
+
+				if (first < 0xE0 || second < 0x80 || second > 0xBF) {
+					continue;
+				}
+				for (const auto third : classes) {
+					const char triple[]{ static_cast<char>(first), static_cast<char>(second), static_cast<char>(third) };
+					check_at({ triple, 3 });
+
+					if (first >= 0xF0 && third >= 0x80 && third <= 0xBF) {
+						for (const auto fourth : classes) {
+							const char quad[]{ static_cast<char>(first), static_cast<char>(second), static_cast<char>(third), static_cast<char>(fourth) };
+							check_at({ quad, 4 });
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void test_every_position()
+	{
+		// a single non-ASCII sequence at each position of an ASCII run, at the boundaries of every vector width
+		for (const auto sequence : { "\xC3\xA9"sv, "\xE5\xAD\x97"sv, "\xE3\x80\x8C"sv, "\xF0\xA0\x80\x80"sv, "\xE5\xAD"sv, "\x80"sv }) {
+			for (std::size_t length = 0; length < 80; ++length) {
+				for (std::size_t pos = 0; pos <= length; ++pos) {
+					std::string text(length, 'a');
+					text.insert(pos, sequence);
+					check_all(text);
+				}
+			}
+		}
+	}
+}
+
+int main()
+{
+	for (const auto kernel : { UTF8::Kernel::kSWAR, UTF8::Kernel::kSSE42, UTF8::Kernel::kAVX2 }) {
+		if (!UTF8::IsSupported(kernel)) {
+			std::printf("kernel %d is not supported here, skipped\n", static_cast<int>(kernel));
+			continue;
+		}
+		UTF8::SetKernel(kernel);
+
+		test_known_answers();
+		test_random_text();
+		test_exhaustive();
+		test_every_position();
+	}
+
+	return Test::Result();
+}
@@ -0,0 +1,145 @@
+#include "VisibilityCache.h"
+
+namespace
+{
+	using Clock = VisibilityCache::Clock;
+	using Result = RayBatch::Result;
+
+	const RE::ObjectRefHandle speaker{ 1 };
+	const RE::NiPoint3        cameraPos{ 0.0f, 0.0f, 0.0f };
+	const RE::NiPoint3        actorPos{ 500.0f, 0.0f, 0.0f };
+	const Clock::time_point   start{ std::chrono::seconds(100) };
+
+	RayBatch::Query make_query(Result a_result, std::uint32_t a_nextPoint = 0)
+	{
+		return { nullptr, 0, RayBatch::pointCount, a_result, 1, a_nextPoint, true };
+	}
+
+	void test_first_cast()
+	{
+		VisibilityCache cache;
+		Test::Check(!cache.Get(speaker, cameraPos, actorPos, start));
+		Test::Check(!cache.GetLast(speaker));
+		Test::Check(cache.GetAge(speaker, start) == Clock::duration::max());
+		Test::Check(cache.GetNextPoint(speaker) == 0);
+
+		// nothing to hold against, the first cast is taken as it is
+		Test::Check(cache.Update(speaker, make_query(Result::kObscured, 2), cameraPos, actorPos, start) == Result::kObscured);
+		Test::Check(cache.GetLast(speaker) == Result::kObscured);
+		Test::Check(cache.GetNextPoint(speaker) == 2);
+		Test::Check(cache.Get(speaker, cameraPos, actorPos, start) == Result::kObscured);
+		Test::Check(!cache.GetLast(RE::ObjectRefHandle{ 2 }));
+	}
+
+	void test_thresholds()
+	{
+		VisibilityCache cache;
+		cache.Update(speaker, make_query(Result::kVisible), cameraPos, actorPos, start);
+
+		// small moves keep the result, the camera has the wider margin
+		Test::Check(cache.Get(speaker, { 15.0f, 0.0f, 0.0f }, actorPos, start) == Result::kVisible);
+		Test::Check(cache.Get(speaker, cameraPos, { 507.0f, 0.0f, 0.0f }, start) == Result::kVisible);
+
+		Test::Check(!cache.Get(speaker, { 0.0f, 17.0f, 0.0f }, actorPos, start));
+		Test::Check(!cache.Get(speaker, cameraPos, { 500.0f, 0.0f, 9.0f }, start));
+		Test::Check(!cache.Get(speaker, { 10.0f, 10.0f, 10.0f }, actorPos, start));
+
+		// the result stays until a new cast replaces it
+		Test::Check(cache.GetLast(speaker) == Result::kVisible);
+	}
+
+	void test_ttl()
+	{
+		VisibilityCache cache;
+		cache.Update(speaker, make_query(Result::kVisible), cameraPos, actorPos, start);
+
+		Test::Check(cache.Get(speaker, cameraPos, actorPos, start + VisibilityCache::ttl) == Result::kVisible);
+		Test::Check(!cache.Get(speaker, cameraPos, actorPos, start + VisibilityCache::ttl + std::chrono::milliseconds(1)));
+		Test::Check(cache.GetAge(speaker, start + std::chrono::milliseconds(100)) == std::chrono::milliseconds(100));
+
+		// a new cast starts the clock again
+		const auto later = start + std::chrono::seconds(1);
+		cache.Update(speaker, make_query(Result::kVisible), cameraPos, actorPos, later);
+		Test::Check(cache.Get(speaker, cameraPos, actorPos, later + VisibilityCache::ttl) == Result::kVisible);
+	}
+
+	void test_hysteresis()
+	{
+		VisibilityCache cache;
+		auto            now = start;
+		const auto      cast = [&](Result a_result) {
+			now += std::chrono::milliseconds(50);
+			return cache.Update(speaker, make_query(a_result), cameraPos, actorPos, now);
+		};
+
+		Test::Check(cast(Result::kVisible) == Result::kVisible);
+
+		// one stray ray is not enough, and the speaker is cast again right away instead of waiting for the ttl
+		Test::Check(cast(Result::kObscured) == Result::kVisible);
+		Test::Check(!cache.Get(speaker, cameraPos, actorPos, now));
+		Test::Check(cast(Result::kVisible) == Result::kVisible);
+		Test::Check(cache.Get(speaker, cameraPos, actorPos, now) == Result::kVisible);
+
+		// two in a row flip it, and back the same way
+		Test::Check(cast(Result::kObscured) == Result::kVisible);
+		Test::Check(cast(Result::kObscured) == Result::kObscured);
+		Test::Check(cache.Get(speaker, cameraPos, actorPos, now) == Result::kObscured);
+		Test::Check(cast(Result::kVisible) == Result::kObscured);
+		Test::Check(cast(Result::kVisible) == Result::kVisible);
+
+		// alternating never settles on the new result
+		for (std::uint32_t i = 0; i < 4; ++i) {
+			Test::Check(cast(i % 2 ? Result::kVisible : Result::kOffscreen) == Result::kVisible);
+		}
+	}
+
+	void test_expiry()
+	{
+		VisibilityCache cache;
+		cache.Update(speaker, make_query(Result::kVisible), cameraPos, actorPos, start);
+		cache.Update(RE::ObjectRefHandle{ 2 }, make_query(Result::kObscured), cameraPos, actorPos, start + std::chrono::seconds(1));
+
+		cache.Prune(start + std::chrono::seconds(2));
+		Test::Check(cache.GetSize() == 2);
+
+		cache.Prune(start + std::chrono::seconds(2) + std::chrono::milliseconds(1));
+		Test::Check(cache.GetSize() == 1);
+		Test::Check(!cache.GetLast(speaker));
+		Test::Check(cache.GetLast(RE::ObjectRefHandle{ 2 }) == Result::kObscured);
+
+		// an expired speaker starts over, its first cast is taken without hysteresis
+		cache.Update(speaker, make_query(Result::kObscured), cameraPos, actorPos, start + std::chrono::seconds(3));
+		Test::Check(cache.GetLast(speaker) == Result::kObscured);
+	}
+
+	void test_counters()
+	{
+		VisibilityCache cache;
+		cache.Prune(start);  // opens the first window
+
+		cache.Update(speaker, make_query(Result::kVisible), cameraPos, actorPos, start);
+		cache.RecordRays(3);
+		cache.Get(speaker, cameraPos, actorPos, start);
+		cache.Get(speaker, cameraPos, actorPos, start);
+		Test::Check(cache.GetHits() == 2 && cache.GetCasts() == 1 && cache.GetRays() == 3);
+
+		// the rate is only rolled over once a second has passed
+		cache.RecordRays(27);
+		cache.Prune(start + std::chrono::milliseconds(500));
+		Test::Check(cache.GetRaysPerSecond() == 0.0f);
+		cache.Prune(start + std::chrono::seconds(1));
+		Test::Check(std::abs(cache.GetRaysPerSecond() - 30.0f) < 0.01f);
+	}
+}
+
+int main()
+{
+	test_first_cast();
+	test_thresholds();
+	test_ttl();
+	test_hysteresis();
+	test_expiry();
+	test_counters();
+
+	return Test::Result();
+}
@@ -0,0 +1,149 @@
+#include "TextLayout.h"
+
+#include <benchmark/benchmark.h>
+
+// Heap allocations of a laid out subtitle. Separate copies the text and wraps into a new vector, the way subtitles
+// were stored before, Together wraps into a reused buffer and copies text and lines into one WrappedText.
+namespace
+{
+	std::atomic<std::uint64_t> allocations{ 0 };
+
+	void* allocate(std::size_t a_size)
+	{
+		++allocations;
+		if (const auto ptr = std::malloc(a_size ? a_size : 1)) {
+			return ptr;
+		}
+		throw std::bad_alloc();
+	}
+
+	void* allocate(std::size_t a_size, std::align_val_t a_alignment)
+	{
+		++allocations;
+		const auto alignment = static_cast<std::size_t>(a_alignment);
+#if defined(_MSC_VER)
+		const auto ptr = _aligned_malloc(a_size ? a_size : 1, alignment);
+#else
+		const auto ptr = std::aligned_alloc(alignment, (std::max<std::size_t>(a_size, 1) + alignment - 1) / alignment * alignment);
+#endif
+		if (ptr) {
+			return ptr;
+		}
+		throw std::bad_alloc();
+	}
+
+	void deallocate(void* a_ptr)
+	{
+		std::free(a_ptr);
+	}
+
+	void deallocate(void* a_ptr, std::align_val_t)
+	{
+#if defined(_MSC_VER)
+		_aligned_free(a_ptr);
+#else
+		std::free(a_ptr);
+#endif
+	}
+}
+
+// Allocations are counted by replacing the global operators, the whole set so every delete frees the way its new
+// allocated. GCC inlines the free into callers and then pairs it with the operator new call instead of the malloc
+// behind it, a mismatch that isn't there, so the warning is silenced for these definitions only.
+#if defined(__GNUC__)
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t a_size) { return allocate(a_size); }
+void* operator new[](std::size_t a_size) { return allocate(a_size); }
+void* operator new(std::size_t a_size, std::align_val_t a_alignment) { return allocate(a_size, a_alignment); }
+void* operator new[](std::size_t a_size, std::align_val_t a_alignment) { return allocate(a_size, a_alignment); }
+
+void operator delete(void* a_ptr) noexcept { deallocate(a_ptr); }
+void operator delete[](void* a_ptr) noexcept { deallocate(a_ptr); }
+void operator delete(void* a_ptr, std::size_t) noexcept { deallocate(a_ptr); }
+void operator delete[](void* a_ptr, std::size_t) noexcept { deallocate(a_ptr); }
+void operator delete(void* a_ptr, std::align_val_t a_alignment) noexcept { deallocate(a_ptr, a_alignment); }
+void operator delete[](void* a_ptr, std::align_val_t a_alignment) noexcept { deallocate(a_ptr, a_alignment); }
+void operator delete(void* a_ptr, std::size_t, std::align_val_t a_alignment) noexcept { deallocate(a_ptr, a_alignment); }
+void operator delete[](void* a_ptr, std::size_t, std::align_val_t a_alignment) noexcept { deallocate(a_ptr, a_alignment); }
+
+#if defined(__GNUC__)
+#	pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+	const GlyphAdvanceTable& get_advances()
+	{
+		static const GlyphAdvanceTable advances([](char32_t) { return 1.0f; }, 16.0f);
+		return advances;
+	}
+
+	// a few hundred dialogue lines of 4 to 40 words, wrapped at the default 50 characters
+	const std::vector<std::string>& get_lines()
+	{
+		static const auto lines = [] {
+			static constexpr std::array words{ "the"sv, "settlement"sv, "needs"sv, "your"sv, "help"sv, "general"sv, "I'll"sv, "mark"sv,
+				"it"sv, "on"sv, "your"sv, "map"sv, "Diamond"sv, "City"sv, "raiders"sv, "are"sv, "attacking"sv, "Preston"sv };
+
+			std::mt19937             rng(0);
+			std::vector<std::string> result(500);
+			for (auto& line : result) {
+				for (auto wordCount = 4 + rng() % 37; wordCount > 0; --wordCount) {
+					line += words[rng() % words.size()];
+					line += wordCount > 1 ? ' ' : '.';
+				}
+			}
+			return result;
+		}();
+		return lines;
+	}
+
+	constexpr float maxWidth = 50.0f;
+
+	void report(benchmark::State& a_state, std::uint64_t a_allocations)
+	{
+		const auto subtitles = static_cast<double>(a_state.iterations() * get_lines().size());
+		a_state.SetItemsProcessed(a_state.iterations() * static_cast<std::int64_t>(get_lines().size()));
+		a_state.counters["allocs/subtitle"] = static_cast<double>(a_allocations) / subtitles;
+	}
+
+	void BM_Separate(benchmark::State& a_state)
+	{
+		std::uint64_t count = 0;
+		for (auto _ : a_state) {
+			for (const auto& line : get_lines()) {
+				const auto start = allocations.load();
+				std::string text(line);
+				auto        lines = TextLayout::Wrap(TextLayout::Script::kLatin, text, maxWidth, get_advances());
+				count += allocations.load() - start;
+				benchmark::DoNotOptimize(lines.data());
+			}
+		}
+		report(a_state, count);
+	}
+
+	void BM_Together(benchmark::State& a_state)
+	{
+		std::vector<TextLayout::Line> lines;
+
+		std::uint64_t count = 0;
+		for (auto _ : a_state) {
+			for (const auto& line : get_lines()) {
+				const auto start = allocations.load();
+				TextLayout::Wrap(TextLayout::Script::kLatin, line, maxWidth, get_advances(), lines);
+				const TextLayout::WrappedText wrapped(line, lines);
+				count += allocations.load() - start;
+				benchmark::DoNotOptimize(wrapped.GetText().data());
+			}
+		}
+		report(a_state, count);
+	}
+}
+
+BENCHMARK(BM_Separate);
+BENCHMARK(BM_Together);
+
+BENCHMARK_MAIN();